@@ -511,6 +511,8 @@ GC_INNER void GC_merge_unmapped(void)
             GC_remove_from_fl_at(hhdr, i);
             GC_remove_from_fl(nexthdr);
             hhdr -> hb_sz += nexthdr -> hb_sz;
+            if ((nexthdr -> hb_flags & ZEROED_BLK) == 0)
+              hhdr -> hb_flags &= ~ZEROED_BLK;
             GC_remove_header(next);
             GC_add_to_fl(h, hhdr);
             /* Start over at beginning of list */
@@ -551,7 +553,7 @@ STATIC struct hblk * GC_get_first_part(struct hblk *h, hdr *hhdr,
         return(0);
     }
     rest_hdr -> hb_sz = total_size - bytes;
-    rest_hdr -> hb_flags = 0;
+    rest_hdr -> hb_flags = (unsigned char)(hhdr -> hb_flags & ZEROED_BLK);
 #   ifdef GC_ASSERTIONS
       /* Mark h not free, to avoid assertion about adjacent free blocks. */
         hhdr -> hb_flags &= ~FREE_BLK;
@@ -586,7 +588,7 @@ STATIC void GC_split_block(struct hblk *h, hdr *hhdr, struct hblk *n,
       nhdr -> hb_prev = prev;
       nhdr -> hb_next = next;
       nhdr -> hb_sz = total_size - h_size;
-      nhdr -> hb_flags = 0;
+      nhdr -> hb_flags = (unsigned char)(hhdr -> hb_flags & ZEROED_BLK);
       if (0 != prev) {
         HDR(prev) -> hb_next = n;
       } else {
@@ -607,7 +609,7 @@ STATIC void GC_split_block(struct hblk *h, hdr *hhdr, struct hblk *n,
 
 STATIC struct hblk *
 GC_allochblk_nth(size_t sz /* bytes */, int kind, unsigned flags, int n,
-                 int may_split);
+                 int may_split, GC_bool *is_zeroed);
 #define AVOID_SPLIT_REMAPPED 2
 
 /*
@@ -621,6 +623,15 @@ GC_allochblk_nth(size_t sz /* bytes */, int kind, unsigned flags, int n,
  */
 GC_INNER struct hblk *
 GC_allochblk(size_t sz, int kind, unsigned flags/* IGNORE_OFF_PAGE or 0 */)
+{
+    GC_bool is_zeroed;
+
+    return GC_allochblk_check_zeroed(sz, kind, flags, &is_zeroed);
+}
+
+GC_INNER struct hblk *
+GC_allochblk_check_zeroed(size_t sz, int kind, unsigned flags,
+                          GC_bool *is_zeroed)
 {
     word blocks;
     int start_list;
@@ -636,7 +647,7 @@ GC_allochblk(size_t sz, int kind, unsigned flags/* IGNORE_OFF_PAGE or 0 */)
     }
     start_list = GC_hblk_fl_from_blocks(blocks);
     /* Try for an exact match first. */
-    result = GC_allochblk_nth(sz, kind, flags, start_list, FALSE);
+    result = GC_allochblk_nth(sz, kind, flags, start_list, FALSE, is_zeroed);
     if (0 != result) return result;
 
     may_split = TRUE;
@@ -668,7 +679,8 @@ GC_allochblk(size_t sz, int kind, unsigned flags/* IGNORE_OFF_PAGE or 0 */)
       ++start_list;
     }
     for (; start_list <= split_limit; ++start_list) {
-        result = GC_allochblk_nth(sz, kind, flags, start_list, may_split);
+        result = GC_allochblk_nth(sz, kind, flags, start_list, may_split,
+                                  is_zeroed);
         if (0 != result)
             break;
     }
@@ -684,7 +696,8 @@ STATIC long GC_large_alloc_warn_suppressed = 0;
 /* AVOID_SPLIT_REMAPPED then memory remapping followed by splitting     */
 /* should be generally avoided).                                        */
 STATIC struct hblk *
-GC_allochblk_nth(size_t sz, int kind, unsigned flags, int n, int may_split)
+GC_allochblk_nth(size_t sz, int kind, unsigned flags, int n, int may_split,
+                 GC_bool *is_zeroed)
 {
     struct hblk *hbp;
     hdr * hhdr;                 /* Header corr. to hbp */
@@ -810,7 +823,8 @@ GC_allochblk_nth(size_t sz, int kind, unsigned flags, int n, int may_split)
                     /* Restore hbp to point at free block */
                       hbp = prev;
                       if (0 == hbp) {
-                        return GC_allochblk_nth(sz, kind, flags, n, may_split);
+                        return GC_allochblk_nth(sz, kind, flags, n, may_split,
+                                                is_zeroed);
                       }
                       hhdr = HDR(hbp);
                   }
@@ -838,6 +852,9 @@ GC_allochblk_nth(size_t sz, int kind, unsigned flags, int n, int may_split)
         if (!GC_install_counts(hbp, (word)size_needed)) return(0);
         /* This leaks memory under very rare conditions. */
 
+    /* Setting up the header for use drops the free block flags. */
+        *is_zeroed = (hhdr -> hb_flags & ZEROED_BLK) != 0;
+
     /* Set up header */
         if (!setup_header(hhdr, hbp, sz, kind, flags)) {
             GC_remove_counts(hbp, (word)size_needed);
@@ -905,6 +922,8 @@ GC_INNER void GC_freehblk(struct hblk *hbp)
          /* no overflow */) {
         GC_remove_from_fl(nexthdr);
         hhdr -> hb_sz += nexthdr -> hb_sz;
+        if ((nexthdr -> hb_flags & ZEROED_BLK) == 0)
+          hhdr -> hb_flags &= ~ZEROED_BLK;
         GC_remove_header(next);
       }
     /* Coalesce with predecessor, if possible. */
@@ -914,6 +933,8 @@ GC_INNER void GC_freehblk(struct hblk *hbp)
             && (signed_word)(hhdr -> hb_sz + prevhdr -> hb_sz) > 0) {
           GC_remove_from_fl(prevhdr);
           prevhdr -> hb_sz += hhdr -> hb_sz;
+          if ((hhdr -> hb_flags & ZEROED_BLK) == 0)
+            prevhdr -> hb_flags &= ~ZEROED_BLK;
 #         ifdef USE_MUNMAP
             prevhdr -> hb_last_reclaimed = (unsigned short)GC_gc_no;
 #         endif
@@ -435,6 +435,12 @@ GC_INLINE void GC_notify_full_gc(void)
 
 STATIC GC_bool GC_is_full_gc = FALSE;
 
+STATIC word GC_full_gc_no = 0;
+                        /* Number of completed full collections.        */
+
+static int n_partial_gcs = 0;
+                        /* Partial collections since the last full one. */
+
 STATIC GC_bool GC_stopped_mark(GC_stop_func stop_func);
 STATIC void GC_finish_collection(void);
 
@@ -448,8 +454,6 @@ STATIC void GC_maybe_gc(void)
     GC_ASSERT(I_HOLD_LOCK());
     ASSERT_CANCEL_DISABLED();
     if (GC_should_collect()) {
-        static int n_partial_gcs = 0;
-
         if (!GC_incremental) {
             /* FIXME: If possible, GC_default_stop_func should be used here */
             GC_try_to_collect_inner(GC_never_stop_func);
@@ -656,6 +660,34 @@ GC_API int GC_CALL GC_get_max_prior_attempts(void)
     return max_prior_attempts;
 }
 
+/* Incremental marking ran out of work: finish the collection with a   */
+/* (time limited, if possible) stopped mark.                            */
+STATIC void GC_finish_incremental_mark(void)
+{
+#   ifdef SAVE_CALL_CHAIN
+        GC_save_callers(GC_last_stack);
+#   endif
+#   ifdef PARALLEL_MARK
+        if (GC_parallel)
+          GC_wait_for_reclaim();
+#   endif
+    if (GC_n_attempts < max_prior_attempts
+        && GC_time_limit != GC_TIME_UNLIMITED) {
+#     ifndef NO_CLOCK
+        GET_TIME(GC_start_time);
+#     endif
+      if (!GC_stopped_mark(GC_timeout_stop_func)) {
+        GC_n_attempts++;
+        return;
+      }
+    } else {
+      /* FIXME: If possible, GC_default_stop_func should be */
+      /* used here.                                         */
+      (void)GC_stopped_mark(GC_never_stop_func);
+    }
+    GC_finish_collection();
+}
+
 GC_INNER void GC_collect_a_little_inner(int n)
 {
     IF_CANCEL(int cancel_state;)
@@ -668,34 +700,24 @@ GC_INNER void GC_collect_a_little_inner(int n)
         int i;
         int max_deficit = GC_rate * n;
 
+#       if defined(PARALLEL_MARK) && !defined(NO_CLOCK)
+          /* A parallel mark phase would otherwise do all of the        */
+          /* remaining marking in this one step.                        */
+          if (GC_parallel && GC_time_limit != GC_TIME_UNLIMITED) {
+            GET_TIME(GC_start_time);
+            GC_parallel_mark_stop_func = GC_timeout_stop_func;
+          }
+#       endif
         for (i = GC_deficit; i < max_deficit; i++) {
             if (GC_mark_some((ptr_t)0)) {
                 /* Need to finish a collection */
-#               ifdef SAVE_CALL_CHAIN
-                    GC_save_callers(GC_last_stack);
-#               endif
-#               ifdef PARALLEL_MARK
-                    if (GC_parallel)
-                      GC_wait_for_reclaim();
-#               endif
-                if (GC_n_attempts < max_prior_attempts
-                    && GC_time_limit != GC_TIME_UNLIMITED) {
-#                 ifndef NO_CLOCK
-                    GET_TIME(GC_start_time);
-#                 endif
-                  if (!GC_stopped_mark(GC_timeout_stop_func)) {
-                    GC_n_attempts++;
-                    break;
-                  }
-                } else {
-                  /* FIXME: If possible, GC_default_stop_func should be */
-                  /* used here.                                         */
-                  (void)GC_stopped_mark(GC_never_stop_func);
-                }
-                GC_finish_collection();
+                GC_finish_incremental_mark();
                 break;
             }
         }
+#       ifdef PARALLEL_MARK
+          GC_parallel_mark_stop_func = 0;
+#       endif
         if (GC_deficit > 0) {
             GC_deficit -= max_deficit;
             if (GC_deficit < 0)
@@ -723,6 +745,127 @@ GC_API int GC_CALL GC_collect_a_little(void)
     return(result);
 }
 
+#if defined(PARALLEL_MARK) && !defined(NO_CLOCK) \
+    && !defined(GC_DISABLE_INCREMENTAL)
+  STATIC CLOCK_TYPE GC_budget_start_time = 0;
+  STATIC unsigned long long GC_budget_ns = 0;
+                                /* Used only in GC_budget_stop_func.    */
+
+  STATIC int GC_CALLBACK GC_budget_stop_func(void)
+  {
+    CLOCK_TYPE current_time;
+
+    GET_TIME(current_time);
+    return NS_TIME_DIFF(current_time, GC_budget_start_time) >= GC_budget_ns;
+  }
+#endif
+
+/* Like GC_collect_a_little, but keep marking until budget_ns have      */
+/* elapsed instead of doing a fixed number of steps.  Starting a        */
+/* collection and the final stopped mark are bounded by GC_time_limit   */
+/* as usual, and count against the budget.                              */
+GC_API int GC_CALL GC_collect_a_little_ns(unsigned long long budget_ns)
+{
+    int result;
+#   if !defined(NO_CLOCK) && !defined(GC_DISABLE_INCREMENTAL)
+      CLOCK_TYPE start_time;
+      CLOCK_TYPE current_time;
+      IF_CANCEL(int cancel_state;)
+#   endif
+    DCL_LOCK_STATE;
+
+    LOCK();
+#   if !defined(NO_CLOCK) && !defined(GC_DISABLE_INCREMENTAL)
+      GET_TIME(start_time);
+      if (!GC_incremental || !GC_collection_in_progress())
+        GC_collect_a_little_inner(1);
+      if (GC_incremental && !GC_dont_gc) {
+        DISABLE_CANCEL(cancel_state);
+#       ifdef PARALLEL_MARK
+          GC_budget_start_time = start_time;
+          GC_budget_ns = budget_ns;
+          GC_parallel_mark_stop_func = GC_budget_stop_func;
+#       endif
+        while (GC_collection_in_progress()) {
+          if (GC_mark_some((ptr_t)0)) {
+            GC_finish_incremental_mark();
+            break;
+          }
+          GET_TIME(current_time);
+          if (NS_TIME_DIFF(current_time, start_time) >= budget_ns)
+            break;
+        }
+#       ifdef PARALLEL_MARK
+          GC_parallel_mark_stop_func = 0;
+#       endif
+        RESTORE_CANCEL(cancel_state);
+      }
+#   else
+      (void)budget_ns;
+      GC_collect_a_little_inner(1);
+#   endif
+    result = (int)GC_collection_in_progress();
+    UNLOCK();
+    if (!result && GC_debugging_started) GC_print_all_smashed();
+    return(result);
+}
+
+/* Collect only what was allocated since the previous collection, plus  */
+/* whatever is reachable from dirty pages, leaving objects marked by    */
+/* earlier collections alone.  Falls back to a full collection when     */
+/* not incremental, or when GC_full_freq partial ones have run.         */
+GC_API void GC_CALL GC_collect_minor(void)
+{
+    IF_CANCEL(int cancel_state;)
+    DCL_LOCK_STATE;
+
+    if (!EXPECT(GC_is_initialized, TRUE)) GC_init();
+    if (GC_debugging_started) GC_print_all_smashed();
+    LOCK();
+    DISABLE_CANCEL(cancel_state);
+    if (!GC_incremental || GC_need_full_gc
+        || n_partial_gcs >= GC_full_freq) {
+      if (GC_try_to_collect_inner(GC_never_stop_func))
+        n_partial_gcs = 0;
+    } else if (!GC_dont_gc) {
+      if (GC_collection_in_progress()) {
+        /* The partial collection is already under way; finish it.  */
+        while (GC_collection_in_progress())
+          GC_collect_a_little_inner(1);
+      } else {
+#       ifdef PARALLEL_MARK
+          if (GC_parallel)
+            GC_wait_for_reclaim();
+#       endif
+        n_partial_gcs++;
+        if (GC_on_collection_event)
+          GC_on_collection_event(GC_EVENT_START);
+        /* As in GC_maybe_gc, running out of time turns this into       */
+        /* incremental marking, finished by GC_collect_a_little_inner.  */
+#       ifndef NO_CLOCK
+          if (GC_time_limit != GC_TIME_UNLIMITED) { GET_TIME(GC_start_time); }
+#       endif
+        if (GC_stopped_mark(GC_time_limit == GC_TIME_UNLIMITED?
+                            GC_never_stop_func : GC_timeout_stop_func)) {
+          GC_finish_collection();
+          if (GC_on_collection_event)
+            GC_on_collection_event(GC_EVENT_END);
+        } else if (!GC_is_full_gc) {
+          /* Count this as the first attempt */
+          GC_n_attempts++;
+        }
+      }
+    }
+    RESTORE_CANCEL(cancel_state);
+    UNLOCK();
+    GC_INVOKE_FINALIZERS();
+}
+
+GC_API GC_word GC_CALL GC_get_full_gc_no(void)
+{
+    return GC_full_gc_no;
+}
+
 #ifndef NO_CLOCK
   /* Variables for world-stop average delay time statistic computation. */
   /* "divisor" is incremented every world-stop and halved when reached  */
@@ -805,11 +948,19 @@ STATIC GC_bool GC_stopped_mark(GC_stop_func stop_func)
             GC_noop6(0,0,0,0,0,0);
 
         GC_initiate_gc();
+#       ifdef PARALLEL_MARK
+          /* A parallel mark phase gives up at the same point.  */
+          if (stop_func != GC_never_stop_func)
+            GC_parallel_mark_stop_func = stop_func;
+#       endif
         for (i = 0;;i++) {
           if ((*stop_func)()) {
             GC_COND_LOG_PRINTF("Abandoned stopped marking after"
                                " %u iterations\n", i);
             GC_deficit = i;     /* Give the mutator a chance.   */
+#           ifdef PARALLEL_MARK
+              GC_parallel_mark_stop_func = 0;
+#           endif
 #           ifdef THREAD_LOCAL_ALLOC
               GC_world_stopped = FALSE;
 #           endif
@@ -831,8 +982,17 @@ STATIC GC_bool GC_stopped_mark(GC_stop_func stop_func)
           }
           if (GC_mark_some(GC_approx_sp())) break;
         }
+#       ifdef PARALLEL_MARK
+          GC_parallel_mark_stop_func = 0;
+#       endif
 
     GC_gc_no++;
+#   if defined(THREADS) && !defined(GC_NO_FINALIZATION)
+      /* Links to unmarked objects stay set until GC_finalize runs,     */
+      /* after the world is restarted; send lock-free readers of them   */
+      /* to the allocation lock until then.                             */
+      GC_BUMP_DL_CLEAR_EPOCH();
+#   endif
     GC_DBGLOG_PRINTF("GC #%lu freed %ld bytes, heap %lu KiB"
                      IF_USE_MUNMAP(" (+ %lu KiB unmapped)") "\n",
                      (unsigned long)GC_gc_no, (long)GC_bytes_found,
@@ -1082,6 +1242,9 @@ STATIC void GC_finish_collection(void)
 
 #   ifndef GC_NO_FINALIZATION
       GC_finalize();
+#     ifdef THREADS
+        GC_BUMP_DL_CLEAR_EPOCH();
+#     endif
 #   endif
 #   ifndef NO_CLOCK
       if (GC_print_stats)
@@ -1129,6 +1292,7 @@ STATIC void GC_finish_collection(void)
     if (GC_is_full_gc) {
         GC_used_heap_size_after_full = USED_HEAP_SIZE;
         GC_need_full_gc = FALSE;
+        GC_full_gc_no++;
     } else {
         GC_need_full_gc = USED_HEAP_SIZE - GC_used_heap_size_after_full
                             > min_bytes_allocd();
@@ -1261,8 +1425,10 @@ GC_INNER word GC_n_heap_sects = 0;
 /*
  * Use the chunk of memory starting at p of size bytes as part of the heap.
  * Assumes p is HBLKSIZE aligned, and bytes is a multiple of HBLKSIZE.
+ * Free_flags is ZEROED_BLK if the memory is known to be all zero, else 0.
  */
-GC_INNER void GC_add_to_heap(struct hblk *p, size_t bytes)
+STATIC void GC_add_to_heap_inner(struct hblk *p, size_t bytes,
+                                 unsigned char free_flags)
 {
     hdr * phdr;
     word endp;
@@ -1295,7 +1461,7 @@ GC_INNER void GC_add_to_heap(struct hblk *p, size_t bytes)
     GC_heap_sects[GC_n_heap_sects].hs_bytes = bytes;
     GC_n_heap_sects++;
     phdr -> hb_sz = bytes;
-    phdr -> hb_flags = 0;
+    phdr -> hb_flags = free_flags;
     GC_freehblk(p);
     GC_heapsize += bytes;
 
@@ -1321,6 +1487,11 @@ GC_INNER void GC_add_to_heap(struct hblk *p, size_t bytes)
     }
 }
 
+GC_INNER void GC_add_to_heap(struct hblk *p, size_t bytes)
+{
+    GC_add_to_heap_inner(p, bytes, 0);
+}
+
 #if !defined(NO_DEBUGGING)
   void GC_print_heap_sects(void)
   {
@@ -1422,7 +1593,11 @@ GC_INNER GC_bool GC_expand_hp_inner(word n)
     }
     GC_prev_heap_addr = GC_last_heap_addr;
     GC_last_heap_addr = (ptr_t)space;
-    GC_add_to_heap(space, bytes);
+#   ifdef GET_MEM_RETURNS_ZEROED
+      GC_add_to_heap_inner(space, bytes, ZEROED_BLK);
+#   else
+      GC_add_to_heap_inner(space, bytes, 0);
+#   endif
     /* Force GC before we are likely to allocate past expansion_slop */
       GC_collect_at_heapsize =
          GC_heapsize + expansion_slop - 2*MAXHINCR*HBLKSIZE;
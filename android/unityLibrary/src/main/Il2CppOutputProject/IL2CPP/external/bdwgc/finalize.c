@@ -302,6 +302,35 @@ GC_INLINE struct disappearing_link *GC_unregister_disappearing_link_inner(
     return curr_dl;
 }
 
+#ifdef THREADS
+  /* Odd from the end of a successful stopped mark until GC_finalize    */
+  /* has cleared the links to unmarked objects, even otherwise.         */
+  GC_INNER volatile AO_t GC_dl_clear_epoch = 0;
+#endif
+
+GC_API void * GC_CALL GC_reveal_disappearing_link(void * * link)
+{
+#   ifdef THREADS
+      void *result;
+      AO_t epoch = AO_load_acquire(&GC_dl_clear_epoch);
+      DCL_LOCK_STATE;
+
+      if ((epoch & 1) == 0) {
+        result = GC_REVEAL_POINTER(AO_load_acquire((volatile AO_t *)link));
+        /* A collection that started after the first load could have  */
+        /* found the object unreachable before we revealed it.        */
+        if (AO_load(&GC_dl_clear_epoch) == epoch)
+          return result;
+      }
+      LOCK();
+      result = GC_REVEAL_POINTER(*link);
+      UNLOCK();
+      return result;
+#   else
+      return GC_REVEAL_POINTER(*link);
+#   endif
+}
+
 GC_API int GC_CALL GC_unregister_disappearing_link(void * * link)
 {
     struct disappearing_link *curr_dl;
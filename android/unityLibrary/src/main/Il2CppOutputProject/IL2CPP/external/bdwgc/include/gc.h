@@ -496,6 +496,10 @@ GC_API GC_ATTR_MALLOC GC_ATTR_ALLOC_SIZE(1) void * GC_CALL
         GC_malloc(size_t /* size_in_bytes */);
 GC_API GC_ATTR_MALLOC GC_ATTR_ALLOC_SIZE(1) void * GC_CALL
         GC_malloc_atomic(size_t /* size_in_bytes */);
+/* Same as GC_malloc_atomic, but the result is always cleared; large    */
+/* objects carved from never-used heap memory are not cleared twice.    */
+GC_API GC_ATTR_MALLOC GC_ATTR_ALLOC_SIZE(1) void * GC_CALL
+        GC_malloc_atomic_zeroed(size_t /* size_in_bytes */);
 GC_API GC_ATTR_MALLOC char * GC_CALL GC_strdup(const char *);
 GC_API GC_ATTR_MALLOC char * GC_CALL
         GC_strndup(const char *, size_t) GC_ATTR_NONNULL(1);
@@ -1378,6 +1382,14 @@ typedef void * (GC_CALLBACK * GC_fn_type)(void * /* client_data */);
 GC_API void * GC_CALL GC_call_with_alloc_lock(GC_fn_type /* fn */,
                                 void * /* client_data */) GC_ATTR_NONNULL(1);
 
+/* Return GC_REVEAL_POINTER(*link) for a disappearing link.  Unlike     */
+/* revealing it directly, this can never resurrect an object the        */
+/* collector has already found unreachable.  The allocation lock is     */
+/* taken only while a collection is between marking and clearing such   */
+/* links, so concurrent readers do not normally contend.                */
+GC_API void * GC_CALL GC_reveal_disappearing_link(void ** /* link */)
+                                                        GC_ATTR_NONNULL(1);
+
 /* These routines are intended to explicitly notify the collector       */
 /* of new threads.  Often this is unnecessary because thread creation   */
 /* is implicitly intercepted by the collector, using header-file        */
@@ -2044,6 +2056,25 @@ GC_API void GC_CALL GC_disable_incremental(void);
 GC_API void GC_CALL GC_start_incremental_collection (void);
 GC_API void GC_CALL GC_set_disable_automatic_collection(int);
 
+/* Generational collection on top of incremental mode: a minor         */
+/* collection only reclaims objects allocated since the previous one.  */
+GC_API void GC_CALL GC_collect_minor(void);
+GC_API GC_word GC_CALL GC_get_full_gc_no(void);
+
+/* Like GC_collect_a_little, but does incremental marking until         */
+/* budget_ns nanoseconds have elapsed instead of a fixed amount of work. */
+GC_API int GC_CALL GC_collect_a_little_ns(unsigned long long /* budget_ns */);
+
+/* Parallel marking.  GC_set_markers_count must be called before        */
+/* GC_INIT and takes precedence over GC_MARKERS; 0 picks the default.   */
+/* Counts include the thread that initiated the collection.  The        */
+/* active count may be lowered (or restored with 0) at any time, but    */
+/* never exceeds the number of marker threads that were started.        */
+GC_API void GC_CALL GC_set_markers_count(unsigned);
+GC_API unsigned GC_CALL GC_get_markers_count(void);
+GC_API void GC_CALL GC_set_active_markers_count(unsigned);
+GC_API unsigned GC_CALL GC_get_active_markers_count(void);
+
 /* APIs for getting access to raw GC heap */
 /* These are NOT thread safe, so should be called with GC lock held */
 typedef void (*GC_heap_section_proc)(void* user_data, GC_PTR start, GC_PTR end);
@@ -69,13 +69,6 @@
 # include <sys/resource.h>
 #endif /* BSD_TIME */
 
-#ifdef PARALLEL_MARK
-# define AO_REQUIRE_CAS
-# if !defined(__GNUC__) && !defined(AO_ASSUME_WINDOWS98)
-#   define AO_ASSUME_WINDOWS98
-# endif
-#endif
-
 #ifndef GC_TINY_FL_H
 # include "../gc_tiny_fl.h"
 #endif
@@ -122,6 +115,15 @@ typedef char * ptr_t;   /* A generic pointer to which we can add        */
 # include "gcconfig.h"
 #endif
 
+/* gcconfig.h may turn on PARALLEL_MARK, so this has to follow it (and  */
+/* precede gc_atomic_ops.h).                                            */
+#ifdef PARALLEL_MARK
+# define AO_REQUIRE_CAS
+# if !defined(__GNUC__) && !defined(AO_ASSUME_WINDOWS98)
+#   define AO_ASSUME_WINDOWS98
+# endif
+#endif
+
 #if !defined(GC_ATOMIC_UNCOLLECTABLE) && defined(ATOMIC_UNCOLLECTABLE)
   /* For compatibility with old-style naming. */
 # define GC_ATOMIC_UNCOLLECTABLE
@@ -340,6 +342,15 @@ EXTERN_C_BEGIN
                         /* for processing by GC_invoke_finalizers.      */
                         /* Invoked with lock.                           */
 
+# ifdef THREADS
+    GC_EXTERN volatile AO_t GC_dl_clear_epoch;
+                        /* Bumped once reachability is decided and once */
+                        /* more after GC_finalize cleared disappearing  */
+                        /* links; see GC_reveal_disappearing_link.      */
+#   define GC_BUMP_DL_CLEAR_EPOCH() \
+                AO_store_release(&GC_dl_clear_epoch, GC_dl_clear_epoch + 1)
+# endif
+
 # ifndef GC_TOGGLE_REFS_NOT_NEEDED
     GC_INNER void GC_process_togglerefs(void);
                         /* Process the toggle-refs before GC starts.    */
@@ -1049,6 +1060,10 @@ struct hblkhdr {
 #       ifdef MARK_BIT_PER_GRANULE
 #         define LARGE_BLOCK 0x20
 #       endif
+#       define ZEROED_BLK 0x40  /* This is a free block whose contents  */
+                                /* are known to be zero, i.e. heap      */
+                                /* memory that has never been handed    */
+                                /* out.  Unmapping preserves this.      */
     unsigned short hb_last_reclaimed;
                                 /* Value of GC_gc_no when block was     */
                                 /* last allocated or swept. May wrap.   */
@@ -1910,6 +1925,12 @@ GC_INNER struct hblk * GC_allochblk(size_t size_in_bytes, int kind,
                                 /* the marker that block is valid       */
                                 /* for objects of indicated size.       */
 
+GC_INNER struct hblk * GC_allochblk_check_zeroed(size_t size_in_bytes,
+                                                 int kind, unsigned flags,
+                                                 GC_bool *is_zeroed);
+                                /* The same, but also reports whether   */
+                                /* the block is known to be all zero.   */
+
 GC_INNER ptr_t GC_alloc_large(size_t lb, int k, unsigned flags);
                         /* Allocate a large block of size lb bytes.     */
                         /* The block is not cleared.                    */
@@ -1920,6 +1941,12 @@ GC_INNER ptr_t GC_alloc_large(size_t lb, int k, unsigned flags);
                         /* Does not update GC_bytes_allocd, but does    */
                         /* other accounting.                            */
 
+GC_INNER ptr_t GC_alloc_large_check_zeroed(size_t lb, int k, unsigned flags,
+                                           GC_bool *is_zeroed);
+                        /* The same, but also reports whether the       */
+                        /* block is known to be all zero, in which case */
+                        /* it does not need clearing.                   */
+
 GC_INNER void GC_freehblk(struct hblk * p);
                                 /* Deallocate a heap block and mark it  */
                                 /* as invalid.                          */
@@ -2535,6 +2562,13 @@ GC_INNER void *GC_store_debug_info_inner(void *p, word sz, const char *str,
 # define COND_DUMP COND_DUMP_CHECKS
 #endif
 
+#ifdef THREADS
+  GC_EXTERN int GC_required_markers_cnt;
+                        /* Marker thread count set by the client before */
+                        /* GC_init, or 0 to use GC_MARKERS or the CPU   */
+                        /* count.                                       */
+#endif
+
 #if defined(PARALLEL_MARK)
   /* We need additional synchronization facilities from the thread      */
   /* support.  We believe these are less performance critical           */
@@ -2545,6 +2579,11 @@ GC_INNER void *GC_store_debug_info_inner(void *p, word sz, const char *str,
                         /* Number of mark threads we would like to have */
                         /* excluding the initiating thread.             */
 
+  GC_EXTERN word GC_active_markers_m1;
+                        /* Upper bound on the helpers that may join a   */
+                        /* mark phase; lets the client use fewer than   */
+                        /* GC_markers_m1 without stopping any threads.  */
+
   /* The mark lock and condition variable.  If the GC lock is also      */
   /* acquired, the GC lock must be acquired first.  The mark lock is    */
   /* used to both protect some variables used by the parallel           */
@@ -2568,6 +2607,13 @@ GC_INNER void *GC_store_debug_info_inner(void *p, word sz, const char *str,
   GC_INNER void GC_wait_marker(void);
   GC_EXTERN word GC_mark_no;            /* Protected by mark lock.      */
 
+  GC_EXTERN GC_stop_func GC_parallel_mark_stop_func;
+                        /* Checked by the initiating marker during a    */
+                        /* parallel mark phase, which stops early (with */
+                        /* the remaining work on the mark stack) once   */
+                        /* it returns nonzero; 0 runs to completion.    */
+                        /* Set and read with the allocation lock held.  */
+
   GC_INNER void GC_help_marker(word my_mark_no);
               /* Try to help out parallel marker for mark cycle         */
               /* my_mark_no.  Returns if the mark cycle finishes or     */
@@ -3298,6 +3298,25 @@ EXTERN_C_BEGIN
 # error "invalid config - PARALLEL_MARK requires GC_THREADS"
 #endif
 
+/* Unity: use per-thread free lists for small objects on pthreads       */
+/* platforms so that GC_malloc, GC_malloc_atomic and GC_gcj_malloc do   */
+/* not take the allocation lock on the common path.  Define             */
+/* GC_NO_THREAD_LOCAL_ALLOC to opt out.  Write barrier validation       */
+/* builds replace the allocation entry points, so they are excluded.    */
+#if defined(GC_PTHREADS) && !defined(CYGWIN32) && !defined(THREAD_LOCAL_ALLOC) \
+    && !defined(GC_NO_THREAD_LOCAL_ALLOC) && !defined(DBG_HDRS_ALL) \
+    && !IL2CPP_ENABLE_WRITE_BARRIER_VALIDATION
+# define THREAD_LOCAL_ALLOC
+#endif
+
+/* Unity: mark with one helper thread per core on pthreads platforms.   */
+/* The client can pick the count with GC_set_markers_count (1 turns     */
+/* helpers off), and GC_NO_PARALLEL_MARK opts out at build time.        */
+#if defined(GC_PTHREADS) && !defined(CYGWIN32) && !defined(PARALLEL_MARK) \
+    && !defined(GC_NO_PARALLEL_MARK)
+# define PARALLEL_MARK
+#endif
+
 #if (((defined(MSWIN32) || defined(MSWINCE)) && !defined(__GNUC__)) \
         || (defined(MSWIN32) && defined(I386)) /* for Win98 */ \
         || (defined(USE_PROC_FOR_LIBRARIES) && defined(THREADS))) \
@@ -3634,6 +3653,11 @@ EXTERN_C_BEGIN
 # else
     ptr_t GC_unix_get_mem(size_t bytes);
 #   define GET_MEM(bytes) (struct hblk *)GC_unix_get_mem(bytes)
+    /* Both sbrk and private anonymous mmap hand out pages the kernel   */
+    /* has zero filled, and we never return them.                       */
+#   ifndef GET_MEM_RETURNS_ZEROED
+#     define GET_MEM_RETURNS_ZEROED
+#   endif
 # endif
 #endif /* GC_PRIVATE_H */
 
@@ -36,6 +36,14 @@ STATIC GC_bool GC_alloc_reclaim_list(struct obj_kind *kind)
 /* Flags is 0 or IGNORE_OFF_PAGE.               */
 /* EXTRA_BYTES were already added to lb.        */
 GC_INNER ptr_t GC_alloc_large(size_t lb, int k, unsigned flags)
+{
+    GC_bool is_zeroed;
+
+    return GC_alloc_large_check_zeroed(lb, k, flags, &is_zeroed);
+}
+
+GC_INNER ptr_t GC_alloc_large_check_zeroed(size_t lb, int k, unsigned flags,
+                                           GC_bool *is_zeroed)
 {
     struct hblk * h;
     word n_blocks;
@@ -54,15 +62,15 @@ GC_INNER ptr_t GC_alloc_large(size_t lb, int k, unsigned flags)
     /* Do our share of marking work */
         if (GC_incremental && !GC_dont_gc)
             GC_collect_a_little_inner((int)n_blocks);
-    h = GC_allochblk(lb, k, flags);
+    h = GC_allochblk_check_zeroed(lb, k, flags, is_zeroed);
 #   ifdef USE_MUNMAP
         if (0 == h) {
             GC_merge_unmapped();
-            h = GC_allochblk(lb, k, flags);
+            h = GC_allochblk_check_zeroed(lb, k, flags, is_zeroed);
         }
 #   endif
     while (0 == h && GC_collect_or_expand(n_blocks, flags != 0, retry)) {
-        h = GC_allochblk(lb, k, flags);
+        h = GC_allochblk_check_zeroed(lb, k, flags, is_zeroed);
         retry = TRUE;
     }
     if (h == 0) {
@@ -85,11 +93,13 @@ GC_INNER ptr_t GC_alloc_large(size_t lb, int k, unsigned flags)
 STATIC ptr_t GC_alloc_large_and_clear(size_t lb, int k, unsigned flags)
 {
     ptr_t result;
+    GC_bool is_zeroed;
 
     GC_ASSERT(I_HOLD_LOCK());
-    result = GC_alloc_large(lb, k, flags);
+    result = GC_alloc_large_check_zeroed(lb, k, flags, &is_zeroed);
     if (result != NULL
-          && (GC_debugging_started || GC_obj_kinds[k].ok_init)) {
+          && (GC_debugging_started
+              || (GC_obj_kinds[k].ok_init && !is_zeroed))) {
         word n_blocks = OBJ_SZ_TO_BLOCKS(lb);
 
         /* Clear the whole block, in case of GC_realloc call. */
@@ -236,6 +246,46 @@ GC_INNER void * GC_generic_malloc_inner(size_t lb, int k)
 # endif
 #endif
 
+/* Allocate a large object of kind k, clearing it if init is set.      */
+/* Blocks that still hold their never-used (zero) contents are not     */
+/* cleared again.  Caller does not hold the allocation lock.           */
+STATIC void * GC_generic_malloc_large(size_t lb, int k, GC_bool init)
+{
+    void * result;
+    size_t lg;
+    size_t lb_rounded;
+    word n_blocks;
+    GC_bool is_zeroed = FALSE;
+    DCL_LOCK_STATE;
+
+    lg = ROUNDED_UP_GRANULES(lb);
+    lb_rounded = GRANULES_TO_BYTES(lg);
+    n_blocks = OBJ_SZ_TO_BLOCKS(lb_rounded);
+    LOCK();
+    result = (ptr_t)GC_alloc_large_check_zeroed(lb_rounded, k, 0,
+                                                &is_zeroed);
+    if (0 != result) {
+      if (GC_debugging_started) {
+        BZERO(result, n_blocks * HBLKSIZE);
+      } else if (!is_zeroed) {
+#       ifdef THREADS
+          /* Clear any memory that might be used for GC descriptors */
+          /* before we release the lock.                            */
+            ((word *)result)[0] = 0;
+            ((word *)result)[1] = 0;
+            ((word *)result)[GRANULES_TO_WORDS(lg)-1] = 0;
+            ((word *)result)[GRANULES_TO_WORDS(lg)-2] = 0;
+#       endif
+      }
+      GC_bytes_allocd += lb_rounded;
+    }
+    UNLOCK();
+    if (init && !GC_debugging_started && !is_zeroed && 0 != result) {
+        BZERO(result, n_blocks * HBLKSIZE);
+    }
+    return result;
+}
+
 GC_API GC_ATTR_MALLOC void * GC_CALL GC_generic_malloc(size_t lb, int k)
 {
     void * result;
@@ -251,36 +301,7 @@ GC_API GC_ATTR_MALLOC void * GC_CALL GC_generic_malloc(size_t lb, int k)
         result = GC_generic_malloc_inner(lb, k);
         UNLOCK();
     } else {
-        size_t lg;
-        size_t lb_rounded;
-        word n_blocks;
-        GC_bool init;
-
-        lg = ROUNDED_UP_GRANULES(lb);
-        lb_rounded = GRANULES_TO_BYTES(lg);
-        n_blocks = OBJ_SZ_TO_BLOCKS(lb_rounded);
-        init = GC_obj_kinds[k].ok_init;
-        LOCK();
-        result = (ptr_t)GC_alloc_large(lb_rounded, k, 0);
-        if (0 != result) {
-          if (GC_debugging_started) {
-            BZERO(result, n_blocks * HBLKSIZE);
-          } else {
-#           ifdef THREADS
-              /* Clear any memory that might be used for GC descriptors */
-              /* before we release the lock.                            */
-                ((word *)result)[0] = 0;
-                ((word *)result)[1] = 0;
-                ((word *)result)[GRANULES_TO_WORDS(lg)-1] = 0;
-                ((word *)result)[GRANULES_TO_WORDS(lg)-2] = 0;
-#           endif
-          }
-          GC_bytes_allocd += lb_rounded;
-        }
-        UNLOCK();
-        if (init && !GC_debugging_started && 0 != result) {
-            BZERO(result, n_blocks * HBLKSIZE);
-        }
+        result = GC_generic_malloc_large(lb, k, GC_obj_kinds[k].ok_init);
     }
     if (0 == result) {
         return((*GC_get_oom_fn())(lb));
@@ -348,6 +369,28 @@ GC_API GC_ATTR_MALLOC void * GC_CALL GC_malloc(size_t lb)
 }
 #endif
 
+/* Allocate lb bytes of pointer-free data that reads as zero.  Large    */
+/* requests served from never-used heap blocks skip the clearing pass.  */
+GC_API GC_ATTR_MALLOC void * GC_CALL GC_malloc_atomic_zeroed(size_t lb)
+{
+    void * result;
+
+    if (SMALL_OBJ(lb)) {
+        result = GC_malloc_atomic(lb);
+        if (EXPECT(result != NULL, TRUE))
+            BZERO(result, lb);
+        return result;
+    }
+    if (EXPECT(GC_have_errors, FALSE))
+      GC_print_all_errors();
+    GC_INVOKE_FINALIZERS();
+    GC_DBG_COLLECT_AT_MALLOC(lb);
+    result = GC_generic_malloc_large(lb, PTRFREE, TRUE);
+    if (0 == result)
+        return((*GC_get_oom_fn())(lb));
+    return GC_clear_stack(result);
+}
+
 GC_API GC_ATTR_MALLOC void * GC_CALL GC_generic_malloc_uncollectable(
                                                         size_t lb, int k)
 {
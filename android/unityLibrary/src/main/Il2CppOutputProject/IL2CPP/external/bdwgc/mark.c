@@ -285,7 +285,9 @@ GC_INNER void GC_initiate_gc(void)
 }
 
 #ifdef PARALLEL_MARK
-    STATIC void GC_do_parallel_mark(void); /* initiate parallel marking. */
+    STATIC GC_bool GC_do_parallel_mark(void);
+                        /* Initiate parallel marking.  Returns FALSE if */
+                        /* GC_parallel_mark_stop_func cut it short.     */
 #endif /* PARALLEL_MARK */
 
 #ifdef GC_DISABLE_INCREMENTAL
@@ -383,9 +385,25 @@ static void alloc_mark_stack(size_t);
               /* asynchronously in multiple threads, without grabbing   */
               /* the allocation lock.                                   */
                 if (GC_parallel) {
-                  GC_do_parallel_mark();
+                  GC_mark_stack_empty_proc mark_stack_empty_proc;
+
+                  if (!GC_do_parallel_mark()) {
+                    /* Out of time; what is left is back on the mark    */
+                    /* stack, as it would be after serial steps.        */
+                    break;
+                  }
                   GC_ASSERT((word)GC_mark_stack_top < (word)GC_first_nonempty);
                   GC_mark_stack_top = GC_mark_stack - 1;
+                  /* Give the client the same chance to push more work  */
+                  /* as in the serial case below, and mark it in        */
+                  /* parallel too.                                      */
+                  mark_stack_empty_proc = GC_get_mark_stack_empty();
+                  if (mark_stack_empty_proc) {
+                    GC_mark_stack_top = mark_stack_empty_proc(
+                                GC_mark_stack_top, GC_mark_stack_limit);
+                    if ((word)GC_mark_stack_top >= (word)GC_mark_stack)
+                      break;
+                  }
                   if (GC_mark_stack_too_small) {
                     alloc_mark_stack(2*GC_mark_stack_size);
                   }
@@ -938,6 +956,13 @@ STATIC unsigned GC_active_count = 0;    /* Number of active helpers.    */
 
 GC_INNER word GC_mark_no = 0;
 
+GC_INNER GC_stop_func GC_parallel_mark_stop_func = 0;
+
+STATIC volatile AO_t GC_parallel_mark_stopped = FALSE;
+                                        /* Set once the stop function   */
+                                        /* fires; every marker then     */
+                                        /* returns its local stack.     */
+
 static mse *main_local_mark_stack;
 
 #ifdef LINT2
@@ -1061,6 +1086,20 @@ STATIC void GC_return_mark_stack(mse * low, mse * high)
 # define N_LOCAL_ITERS 1
 #endif
 
+/* Only the initiating thread (id 0) holds the allocation lock, so it   */
+/* alone calls the stop function; the helpers just watch for the flag.  */
+static GC_bool parallel_mark_should_stop(int id)
+{
+  if (AO_load(&GC_parallel_mark_stopped))
+    return TRUE;
+  if (id == 0 && GC_parallel_mark_stop_func != 0
+      && (*GC_parallel_mark_stop_func)()) {
+    AO_store(&GC_parallel_mark_stopped, TRUE);
+    return TRUE;
+  }
+  return FALSE;
+}
+
 /* This function is only called when the local  */
 /* and the main mark stacks are both empty.     */
 static GC_bool has_inactive_helpers(void)
@@ -1078,7 +1117,7 @@ static GC_bool has_inactive_helpers(void)
 /* But this may be achieved by copying the      */
 /* local mark stack back into the global one.   */
 /* We do not hold the mark lock.                */
-STATIC void GC_do_local_mark(mse *local_mark_stack, mse *local_top)
+STATIC void GC_do_local_mark(mse *local_mark_stack, mse *local_top, int id)
 {
     unsigned n;
 
@@ -1093,6 +1132,10 @@ STATIC void GC_do_local_mark(mse *local_mark_stack, mse *local_top)
                 return;
             }
         }
+        if (parallel_mark_should_stop(id)) {
+            GC_return_mark_stack(local_mark_stack, local_top);
+            return;
+        }
         if ((word)AO_load((volatile AO_t *)&GC_mark_stack_top)
             < (word)AO_load(&GC_first_nonempty)
             && (word)local_top > (word)(local_mark_stack + 1)
@@ -1141,6 +1184,21 @@ STATIC void GC_mark_local(mse *local_mark_stack, int id)
         mse * local_top;
         mse * global_first_nonempty = (mse *)AO_load(&GC_first_nonempty);
 
+        if (parallel_mark_should_stop(id)) {
+            /* Our local stack is already back on the global one; wait  */
+            /* for the other markers to return theirs.                  */
+            GC_acquire_mark_lock();
+            GC_active_count--;
+            if (0 == GC_active_count) GC_notify_all_marker();
+            while (GC_active_count > 0) {
+                GC_wait_marker();
+            }
+            GC_helper_count--;
+            GC_VERBOSE_LOG_PRINTF("Stopped mark helper %d\n", id);
+            if (0 == GC_helper_count) GC_notify_all_marker();
+            return;
+        }
+
         GC_ASSERT((word)my_first_nonempty >= (word)GC_mark_stack &&
                   (word)my_first_nonempty <=
                         (word)AO_load((volatile AO_t *)&GC_mark_stack_top)
@@ -1215,16 +1273,20 @@ STATIC void GC_mark_local(mse *local_mark_stack, int id)
                   (word)my_first_nonempty <=
                         (word)AO_load((volatile AO_t *)&GC_mark_stack_top)
                         + sizeof(mse));
-        GC_do_local_mark(local_mark_stack, local_top);
+        GC_do_local_mark(local_mark_stack, local_top, id);
     }
 }
 
+GC_INNER word GC_active_markers_m1 = ~(word)0;
+
 /* Perform Parallel mark.                       */
 /* We hold the GC lock, not the mark lock.      */
-/* Currently runs until the mark stack is       */
-/* empty.                                       */
-STATIC void GC_do_parallel_mark(void)
+/* Runs until the mark stack is empty, or until */
+/* GC_parallel_mark_stop_func fires.            */
+STATIC GC_bool GC_do_parallel_mark(void)
 {
+    GC_bool finished = TRUE;
+
     GC_acquire_mark_lock();
     GC_ASSERT(I_HOLD_LOCK());
     /* This could be a GC_ASSERT, but it seems safer to keep it on      */
@@ -1236,6 +1298,7 @@ STATIC void GC_do_parallel_mark(void)
     GC_first_nonempty = (AO_t)GC_mark_stack;
     GC_active_count = 0;
     GC_helper_count = 1;
+    AO_store(&GC_parallel_mark_stopped, FALSE);
     GC_help_wanted = TRUE;
     GC_notify_all_marker();
         /* Wake up potential helpers.   */
@@ -1246,11 +1309,26 @@ STATIC void GC_do_parallel_mark(void)
       GC_wait_marker();
     }
     /* GC_helper_count cannot be incremented while GC_help_wanted == FALSE */
-    GC_VERBOSE_LOG_PRINTF("Finished marking for mark phase number %lu\n",
+    if (AO_load(&GC_parallel_mark_stopped)) {
+      /* Squeeze out the entries the markers stole (their descriptors   */
+      /* are cleared) so that repeated stops do not fill the stack.     */
+      mse *p;
+      mse *top = GC_mark_stack - 1;
+
+      for (p = GC_mark_stack; (word)p <= (word)GC_mark_stack_top; ++p) {
+        if (p->mse_descr.w != 0)
+          *++top = *p;
+      }
+      GC_mark_stack_top = top;
+      finished = (word)top < (word)GC_mark_stack;
+    }
+    GC_VERBOSE_LOG_PRINTF("%s marking for mark phase number %lu\n",
+                          finished ? "Finished" : "Stopped",
                           (unsigned long)GC_mark_no);
     GC_mark_no++;
     GC_release_mark_lock();
     GC_notify_all_marker();
+    return finished;
 }
 
 
@@ -1270,7 +1348,8 @@ GC_INNER void GC_help_marker(word my_mark_no)
       GC_wait_marker();
     }
     my_id = GC_helper_count;
-    if (GC_mark_no != my_mark_no || my_id > (unsigned)GC_markers_m1) {
+    if (GC_mark_no != my_mark_no || my_id > (unsigned)GC_markers_m1
+        || my_id > GC_active_markers_m1) {
       /* Second test is useful only if original threads can also        */
       /* act as helpers.  Under Linux they can't.                       */
       return;
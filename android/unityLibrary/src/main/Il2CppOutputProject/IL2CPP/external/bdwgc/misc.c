@@ -2513,6 +2513,48 @@ GC_API int GC_CALL GC_get_dont_precollect(void)
     return GC_dont_precollect;
 }
 
+#ifdef THREADS
+  GC_INNER int GC_required_markers_cnt = 0;
+#endif
+
+GC_API void GC_CALL GC_set_markers_count(unsigned markers)
+{
+#   ifdef THREADS
+      GC_required_markers_cnt = markers < INT_MAX ? (int)markers : INT_MAX;
+#   endif
+}
+
+GC_API unsigned GC_CALL GC_get_markers_count(void)
+{
+#   ifdef PARALLEL_MARK
+      return (unsigned)GC_markers_m1 + 1;
+#   else
+      return 1;
+#   endif
+}
+
+GC_API void GC_CALL GC_set_active_markers_count(unsigned markers)
+{
+#   ifdef PARALLEL_MARK
+      DCL_LOCK_STATE;
+
+      /* Helpers only read the limit during a mark phase, which runs    */
+      /* with the allocation lock held.                                 */
+      LOCK();
+      GC_active_markers_m1 = markers > 0 ? (word)markers - 1 : ~(word)0;
+      UNLOCK();
+#   endif
+}
+
+GC_API unsigned GC_CALL GC_get_active_markers_count(void)
+{
+#   ifdef PARALLEL_MARK
+      if (GC_active_markers_m1 < (word)GC_markers_m1)
+        return (unsigned)GC_active_markers_m1 + 1;
+#   endif
+    return GC_get_markers_count();
+}
+
 GC_API void GC_CALL GC_set_full_freq(int value)
 {
     GC_ASSERT(value >= 0);
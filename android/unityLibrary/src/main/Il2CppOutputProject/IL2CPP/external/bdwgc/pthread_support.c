@@ -1267,9 +1267,12 @@ GC_INNER void GC_thr_init(void)
 #   ifdef PARALLEL_MARK
       {
         char * markers_string = GETENV("GC_MARKERS");
-        int markers;
+        int markers = GC_required_markers_cnt;
 
-        if (markers_string != NULL) {
+        if (markers > 0) {
+          if (markers > MAX_MARKERS)
+            markers = MAX_MARKERS;
+        } else if (markers_string != NULL) {
           markers = atoi(markers_string);
           if (markers <= 0 || markers > MAX_MARKERS) {
             WARN("Too big or invalid number of mark threads: %" WARN_PRIdPTR
@@ -1298,8 +1301,8 @@ GC_INNER void GC_thr_init(void)
       GC_COND_LOG_PRINTF(
                 "Single marker thread, turning off parallel marking\n");
     } else {
-      /* Disable true incremental collection, but generational is OK.   */
-      GC_time_limit = GC_TIME_UNLIMITED;
+      /* Unity: GC_time_limit is kept; a parallel mark phase stops at   */
+      /* the same stop function as the serial marker does.              */
       setup_mark_lock();
     }
 # endif
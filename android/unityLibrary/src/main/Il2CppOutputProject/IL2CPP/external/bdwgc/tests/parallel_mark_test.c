@@ -0,0 +1,348 @@
+/*
+ * THIS MATERIAL IS PROVIDED AS IS, WITH ABSOLUTELY NO WARRANTY EXPRESSED
+ * OR IMPLIED.  ANY USE IS AT YOUR OWN RISK.
+ *
+ * Permission is hereby granted to use or copy this program
+ * for any purpose,  provided the above notices are retained on all copies.
+ * Permission to modify the code and to distribute modified code is granted,
+ * provided the above notices are retained, and a notice that the code was
+ * modified is included with the above copyright notice.
+ */
+
+/* Unity: check that marking with several marker threads keeps          */
+/* everything reachable through the mark procedures the runtime         */
+/* installs: a gcj vector mark proc in the shape of GC_gcj_vector_proc, */
+/* over bitmap and extended element descriptors, and a mark stack empty */
+/* callback that pushes ephemeron values whose keys are marked.  The    */
+/* incremental runs use a tiny time limit so that parallel mark phases  */
+/* also get stopped part way and resumed.                               */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#ifdef HAVE_CONFIG_H
+  /* For GC_[P]THREADS */
+# include "config.h"
+#endif
+
+#ifndef GC_GCJ_SUPPORT
+# define GC_GCJ_SUPPORT
+#endif
+
+#include "gc.h"
+#include "gc_mark.h"
+#include "gc_gcj.h"
+#include "gc_typed.h"
+#include "gc_vector.h"
+
+#define my_assert(e) \
+    if (!(e)) { \
+        fflush(stdout); \
+        fprintf(stderr, "Assertion failure, line %d: " #e "\n", __LINE__); \
+        exit(-1); \
+    }
+
+#define MARKERS 4
+#define VECTOR_PROC_INDEX 6
+
+#define SMALL_ARRAYS 64
+#define SMALL_LENGTH 1000       /* more than ELEMENT_CHUNK_SIZE bulk    */
+                                /* entries, so the proc continues       */
+#define SMALL_ELEMENT_WORDS 2   /* one pointer, one scalar              */
+
+#define LARGE_ARRAYS 8
+#define LARGE_LENGTH 300        /* more than ELEMENT_CHUNK_SIZE         */
+#define LARGE_ELEMENT_WORDS 70  /* too wide for a bitmap descriptor     */
+
+#define EPHEMERONS 4096
+
+#define LEAF_MAGIC ((GC_word)0x5a5a1234)
+
+/* Stands in for the runtime's array class.     */
+typedef struct {
+    GC_descr element_desc;
+    int words_per_element;
+} vector_type;
+
+/* Laid out like the runtime's arrays: type, length, then elements.     */
+typedef struct {
+    vector_type *type;
+    GC_word length;
+    GC_word elements[1];
+} vector;
+
+typedef struct {
+    GC_hidden_pointer key;
+    GC_hidden_pointer value;
+} ephemeron;
+
+static vector_type small_type;
+static vector_type large_type;
+
+static vector **arrays;         /* uncollectable, the only array roots  */
+static void **keys;             /* uncollectable, keeps even keys alive */
+static ephemeron *ephemerons;   /* malloc'd, so not scanned             */
+
+/* Disappearing links, cleared by the collector when a tracked object   */
+/* is reclaimed.  Also malloc'd.                                        */
+static GC_hidden_pointer *leaf_links;
+static size_t leaf_count;
+static GC_hidden_pointer *value_links;
+static GC_hidden_pointer *child_links;
+
+static struct GC_ms_entry *vector_proc(GC_word *addr,
+                                       struct GC_ms_entry *mark_stack_ptr,
+                                       struct GC_ms_entry *mark_stack_limit,
+                                       GC_word env)
+{
+    vector *v = env ? (vector *)GC_base(addr) : (vector *)addr;
+    GC_word *start;
+    GC_word *end;
+
+    if (0 == v->length)
+        return mark_stack_ptr;
+
+    /* start at the first element or resume from the last chunk */
+    start = env ? addr : v->elements;
+    end = v->elements + v->length * v->type->words_per_element;
+    return GC_gcj_vector_mark_proc(mark_stack_ptr, mark_stack_limit,
+                                   v->type->element_desc, start, end,
+                                   v->type->words_per_element);
+}
+
+static struct GC_ms_entry *push_ephemerons(
+                                    struct GC_ms_entry *mark_stack_ptr,
+                                    struct GC_ms_entry *mark_stack_limit)
+{
+    int i;
+
+    for (i = 0; i < EPHEMERONS; i++) {
+        void *key;
+
+        if (0 == ephemerons[i].key || 0 == ephemerons[i].value)
+            continue;
+        key = GC_REVEAL_POINTER(ephemerons[i].key);
+        if (!GC_is_marked(key))
+            continue;
+        mark_stack_ptr = GC_mark_and_push(
+                                GC_REVEAL_POINTER(ephemerons[i].value),
+                                mark_stack_ptr, mark_stack_limit,
+                                (void **)&ephemerons[i].value);
+    }
+    return mark_stack_ptr;
+}
+
+static void *checked(void *p)
+{
+    if (NULL == p) {
+        fprintf(stderr, "Out of memory!\n");
+        exit(3);
+    }
+    return p;
+}
+
+static void *new_leaf(size_t link_index)
+{
+    GC_word *leaf = (GC_word *)checked(GC_MALLOC_ATOMIC(2 * sizeof(GC_word)));
+
+    leaf[0] = LEAF_MAGIC;
+    leaf[1] = (GC_word)link_index;
+    leaf_links[link_index] = GC_HIDE_POINTER(leaf);
+    my_assert(GC_GENERAL_REGISTER_DISAPPEARING_LINK(
+                                (void **)&leaf_links[link_index], leaf) == 0);
+    return leaf;
+}
+
+static vector *new_vector(vector_type *type, size_t length)
+{
+    size_t bytes = sizeof(vector) - sizeof(GC_word)
+                    + length * type->words_per_element * sizeof(GC_word);
+    vector *v = (vector *)checked(GC_gcj_vector_malloc(bytes, type));
+
+    v->length = length;
+    GC_end_stubborn_change(v);
+    return v;
+}
+
+static void build_arrays(void)
+{
+    size_t i, j;
+    size_t next_leaf = 0;
+
+    for (i = 0; i < SMALL_ARRAYS; i++) {
+        vector *v = new_vector(&small_type, SMALL_LENGTH);
+
+        for (j = 0; j < SMALL_LENGTH; j++) {
+            GC_word *element = v->elements + j * SMALL_ELEMENT_WORDS;
+
+            element[0] = (GC_word)new_leaf(next_leaf++);
+            element[1] = LEAF_MAGIC;    /* scalar, must not be traced */
+        }
+        GC_end_stubborn_change(v);
+        arrays[i] = v;
+        GC_end_stubborn_change(arrays);
+    }
+
+    for (i = 0; i < LARGE_ARRAYS; i++) {
+        vector *v = new_vector(&large_type, LARGE_LENGTH);
+
+        for (j = 0; j < LARGE_LENGTH; j++) {
+            GC_word *element = v->elements + j * LARGE_ELEMENT_WORDS;
+
+            element[0] = (GC_word)new_leaf(next_leaf++);
+            element[LARGE_ELEMENT_WORDS - 1] = (GC_word)new_leaf(next_leaf++);
+        }
+        GC_end_stubborn_change(v);
+        arrays[SMALL_ARRAYS + i] = v;
+        GC_end_stubborn_change(arrays);
+    }
+    my_assert(next_leaf == leaf_count);
+}
+
+static void build_ephemerons(void)
+{
+    int i;
+
+    for (i = 0; i < EPHEMERONS; i++) {
+        void *key = checked(GC_MALLOC(2 * sizeof(GC_word)));
+        void **value = (void **)checked(GC_MALLOC(2 * sizeof(void *)));
+        GC_word *child = (GC_word *)checked(
+                                GC_MALLOC_ATOMIC(2 * sizeof(GC_word)));
+
+        child[0] = LEAF_MAGIC;
+        value[0] = child;       /* only reachable through the value */
+        GC_end_stubborn_change(value);
+
+        ephemerons[i].key = GC_HIDE_POINTER(key);
+        ephemerons[i].value = GC_HIDE_POINTER(value);
+        my_assert(GC_GENERAL_REGISTER_DISAPPEARING_LINK(
+                                (void **)&ephemerons[i].key, key) == 0);
+        my_assert(GC_GENERAL_REGISTER_DISAPPEARING_LINK(
+                                (void **)&ephemerons[i].value, value) == 0);
+
+        value_links[i] = GC_HIDE_POINTER(value);
+        child_links[i] = GC_HIDE_POINTER(child);
+        my_assert(GC_GENERAL_REGISTER_DISAPPEARING_LINK(
+                                (void **)&value_links[i], value) == 0);
+        my_assert(GC_GENERAL_REGISTER_DISAPPEARING_LINK(
+                                (void **)&child_links[i], child) == 0);
+
+        /* Keep every other key; the rest, and their values, must go. */
+        if (i % 2 == 0) {
+            keys[i / 2] = key;
+            GC_end_stubborn_change(keys);
+        }
+    }
+}
+
+/* Allocate garbage so that anything reclaimed by mistake gets reused. */
+static void churn(int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        GC_word *p = (GC_word *)checked(GC_MALLOC_ATOMIC(2 * sizeof(GC_word)));
+
+        p[0] = ~LEAF_MAGIC;
+        p[1] = ~LEAF_MAGIC;
+    }
+}
+
+static void check_reachable(const char *phase)
+{
+    size_t i;
+    int dead_values = 0;
+
+    for (i = 0; i < leaf_count; i++) {
+        GC_word *leaf;
+
+        my_assert(leaf_links[i] != 0);
+        leaf = (GC_word *)GC_REVEAL_POINTER(leaf_links[i]);
+        my_assert(leaf[0] == LEAF_MAGIC && leaf[1] == (GC_word)i);
+    }
+
+    for (i = 0; i < EPHEMERONS; i++) {
+        if (i % 2 == 0) {
+            GC_word *child;
+
+            my_assert(value_links[i] != 0 && child_links[i] != 0);
+            child = (GC_word *)GC_REVEAL_POINTER(child_links[i]);
+            my_assert(child[0] == LEAF_MAGIC);
+        } else if (0 == value_links[i]) {
+            dead_values++;
+        }
+    }
+
+    /* Stray stack words can keep the odd one alive conservatively. */
+    printf("%s: %lu leaves intact, %d of %d unkeyed values reclaimed\n",
+           phase, (unsigned long)leaf_count, dead_values, EPHEMERONS / 2);
+}
+
+int main(void)
+{
+    GC_word small_bitmap[1] = { 0 };
+    GC_word large_bitmap[(LARGE_ELEMENT_WORDS + 2 + 8 * sizeof(GC_word) - 1)
+                         / (8 * sizeof(GC_word))] = { 0 };
+    int round;
+
+    GC_set_markers_count(MARKERS);
+    GC_INIT();
+    GC_init_gcj_malloc(0, NULL);
+    GC_init_gcj_vector(VECTOR_PROC_INDEX, (void *)vector_proc);
+    GC_set_mark_stack_empty(push_ephemerons);
+
+    if (GC_get_markers_count() < 2) {
+        printf("Parallel mark test skipped: single marker\n");
+        return 0;
+    }
+
+    /* Element descriptors count the two word header of a boxed value. */
+    GC_set_bit(small_bitmap, 2);
+    small_type.element_desc = GC_make_descriptor(small_bitmap, 4);
+    small_type.words_per_element = SMALL_ELEMENT_WORDS;
+    my_assert((small_type.element_desc & GC_DS_TAGS) == GC_DS_BITMAP);
+
+    GC_set_bit(large_bitmap, 2);
+    GC_set_bit(large_bitmap, LARGE_ELEMENT_WORDS + 1);
+    large_type.element_desc = GC_make_descriptor(large_bitmap,
+                                                 LARGE_ELEMENT_WORDS + 2);
+    large_type.words_per_element = LARGE_ELEMENT_WORDS;
+    my_assert((large_type.element_desc & GC_DS_TAGS) == GC_DS_PROC);
+
+    leaf_count = SMALL_ARRAYS * SMALL_LENGTH + LARGE_ARRAYS * LARGE_LENGTH * 2;
+    leaf_links = (GC_hidden_pointer *)checked(
+                        calloc(leaf_count, sizeof(GC_hidden_pointer)));
+    ephemerons = (ephemeron *)checked(calloc(EPHEMERONS, sizeof(ephemeron)));
+    value_links = (GC_hidden_pointer *)checked(
+                        calloc(EPHEMERONS, sizeof(GC_hidden_pointer)));
+    child_links = (GC_hidden_pointer *)checked(
+                        calloc(EPHEMERONS, sizeof(GC_hidden_pointer)));
+    arrays = (vector **)checked(GC_MALLOC_UNCOLLECTABLE(
+                        (SMALL_ARRAYS + LARGE_ARRAYS) * sizeof(vector *)));
+    keys = (void **)checked(GC_MALLOC_UNCOLLECTABLE(
+                        (EPHEMERONS / 2) * sizeof(void *)));
+
+    build_arrays();
+    build_ephemerons();
+
+    for (round = 0; round < 3; round++) {
+        churn(100000);
+        GC_gcollect();
+    }
+    check_reachable("Full collections");
+
+    /* Full marks every cycle, so there is enough work to stop. */
+    GC_enable_incremental();
+    GC_set_full_freq(0);
+    GC_set_time_limit_ns(20000);
+    for (round = 0; round < 20; round++) {
+        churn(100000);
+        while (GC_collect_a_little_ns(10000)) {
+            churn(1000);
+        }
+    }
+    check_reachable("Time-sliced collections");
+
+    printf("SUCCEEDED\n");
+    return 0;
+}
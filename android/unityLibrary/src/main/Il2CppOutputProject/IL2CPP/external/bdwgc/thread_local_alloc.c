@@ -221,10 +221,16 @@ GC_API GC_ATTR_MALLOC void * GC_CALL GC_gcj_malloc(size_t bytes,
   } else {
     size_t granules = ROUNDED_UP_GRANULES(bytes);
     void *result;
+    void *tsd;
     void **tiny_fl;
 
     GC_ASSERT(GC_gcj_malloc_initialized);
-    tiny_fl = ((GC_tlfs)GC_getspecific(GC_thread_key))->gcj_freelists;
+    tsd = GC_getspecific(GC_thread_key);
+    /* Unity: threads that were never registered with the collector    */
+    /* have no free list structure; fall back to the global lock.       */
+    if (EXPECT(0 == tsd, FALSE))
+      return GC_core_gcj_malloc(bytes, ptr_to_struct_containing_descr);
+    tiny_fl = ((GC_tlfs)tsd)->gcj_freelists;
     GC_FAST_MALLOC_GRANS(result, granules, tiny_fl, DIRECT_GRANULES,
                          GC_gcj_kind,
                          GC_core_gcj_malloc(bytes,
@@ -91,13 +91,10 @@ GC_API void GC_CALL GC_init_gcj_vector (int mp_index,
     GC_clear_stack(GC_generic_malloc_inner_ignore_off_page(lb, k))
 
 #if !IL2CPP_ENABLE_WRITE_BARRIER_VALIDATION
-#ifdef THREAD_LOCAL_ALLOC
-  GC_INNER void * GC_gcj_vector_malloc(size_t lb,
-                                     void * ptr_to_struct_containing_descr)
-#else
+  /* There is no thread-local variant of the vector kind, so this is    */
+  /* the public entry point even when THREAD_LOCAL_ALLOC is defined.    */
   GC_API GC_ATTR_MALLOC void * GC_CALL GC_gcj_vector_malloc (size_t lb,
     void * ptr_to_struct_containing_descr)
-#endif
   {
     ptr_t op;
     DCL_LOCK_STATE;
@@ -141,9 +138,56 @@ GC_API void GC_CALL GC_init_gcj_vector (int mp_index,
   }
 #define ELEMENT_CHUNK_SIZE 256
 
+/* Elements with an extended (typd_mlc.c) descriptor are too large to    */
+/* shift into a bitmap, so push one entry per element carrying the       */
+/* element descriptor itself.  Like the bitmap case, that descriptor     */
+/* counts the two word object header of a boxed value, so each entry     */
+/* starts two words before its element; the header bits are never set.   */
+STATIC mse *
+GC_gcj_vector_push_extended_elements (mse *mark_stack_ptr, mse* mark_stack_limit, GC_descr element_desc, word *start, word *end, int words_per_element)
+{
+  size_t remainder_count = (end - start) / words_per_element;
+  word *current = start;
+
+  if (mark_stack_ptr >= mark_stack_limit)
+    return GC_signal_mark_stack_overflow (mark_stack_ptr);
+
+  if (remainder_count > ELEMENT_CHUNK_SIZE) {
+    remainder_count = ELEMENT_CHUNK_SIZE;
+
+    /* only process chunk number of items */
+    end = start + remainder_count * words_per_element;
+
+    mark_stack_ptr++;
+    if (mark_stack_ptr >= mark_stack_limit)
+      mark_stack_ptr = GC_signal_mark_stack_overflow (mark_stack_ptr);
+
+    mark_stack_ptr->mse_descr.w = GC_MAKE_PROC (GC_gcj_vector_mp_index, 1 /* continue processing */);
+    mark_stack_ptr->mse_start = (ptr_t)end;
+  }
+
+  while (remainder_count > 0) {
+    mark_stack_ptr++;
+    if (mark_stack_ptr >= mark_stack_limit)
+      mark_stack_ptr = GC_signal_mark_stack_overflow (mark_stack_ptr);
+
+    mark_stack_ptr->mse_start = (ptr_t) (current - 2);
+    mark_stack_ptr->mse_descr.w = element_desc;
+
+    current += words_per_element;
+
+    remainder_count--;
+  }
+
+  return (mark_stack_ptr);
+}
+
 GC_API mse *GC_CALL
 GC_gcj_vector_mark_proc (mse *mark_stack_ptr, mse* mark_stack_limit, GC_descr element_desc, word *start, word *end, int words_per_element)
 {
+  if ((element_desc & GC_DS_TAGS) == GC_DS_PROC)
+    return GC_gcj_vector_push_extended_elements (mark_stack_ptr, mark_stack_limit, element_desc, start, end, words_per_element);
+
   /* create new descriptor that is shifted two bits to account 
   * for lack of object header. Descriptors for value types include
   * the object header for boxed values */
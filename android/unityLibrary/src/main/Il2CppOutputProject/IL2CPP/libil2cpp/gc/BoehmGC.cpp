@@ -7,13 +7,17 @@
 #include "GarbageCollector.h"
 #include "WriteBarrier.h"
 #include "WriteBarrierValidation.h"
+#include "os/Atomic.h"
+#include "os/Environment.h"
 #include "os/Mutex.h"
+#include "os/Time.h"
 #include "vm/Array.h"
 #include "vm/Domain.h"
 #include "vm/Profiler.h"
 #include "utils/Il2CppHashMap.h"
 #include "utils/HashUtils.h"
 #include "il2cpp-object-internals.h"
+#include "il2cpp-runtime-stats.h"
 
 #include "Baselib.h"
 #include "Cpp/ReentrantLock.h"
@@ -24,6 +28,17 @@ static bool s_GCInitialized = false;
 static bool s_PendingGC = false;
 #endif
 
+// Marker threads requested before the GC was initialized; 0 keeps bdwgc's default (GC_MARKERS
+// or one per core). Only builds with PARALLEL_MARK start helper threads.
+static int32_t s_RequestedMarkerThreads = 0;
+
+#if IL2CPP_ENABLE_WRITE_BARRIERS
+// Opt-in with IL2CPP_GC_GENERATIONAL. In incremental mode bdwgc keeps mark bits between partial
+// collections and rescans only the pages dirtied through the write barriers, so generation 0 is
+// everything allocated since the last collection and generation 1 is the whole heap.
+static bool s_GenerationalMode = false;
+#endif
+
 static void on_gc_event(GC_EventType eventType);
 #if IL2CPP_ENABLE_PROFILER
 using il2cpp::vm::Profiler;
@@ -79,7 +94,7 @@ GC_ms_entry* GC_gcj_vector_proc(GC_word* addr, GC_ms_entry* mark_stack_ptr,
     Il2CppClass* element_type = array_type->element_class;
     GC_descr element_desc = (GC_descr)element_type->gc_desc;
 
-    IL2CPP_ASSERT((element_desc & GC_DS_TAGS) == GC_DS_BITMAP);
+    IL2CPP_ASSERT((element_desc & GC_DS_TAGS) == GC_DS_BITMAP || (element_desc & GC_DS_TAGS) == GC_DS_PROC);
     IL2CPP_ASSERT(element_type->byval_arg.valuetype);
 
     int words_per_element = array_type->element_size / BYTES_PER_WORD;
@@ -120,8 +135,15 @@ il2cpp::gc::GarbageCollector::Initialize()
     GC_enable_incremental();
 #if IL2CPP_INCREMENTAL_TIME_SLICE
     GC_set_time_limit(IL2CPP_INCREMENTAL_TIME_SLICE);
+#endif
+    s_GenerationalMode = !il2cpp::os::Environment::GetEnvironmentVariable("IL2CPP_GC_GENERATIONAL").empty();
+#if !IL2CPP_INCREMENTAL_TIME_SLICE
+    // Without a time slice to honor, run each minor collection to completion in a single short pause.
+    if (s_GenerationalMode)
+        GC_set_time_limit(GC_TIME_UNLIMITED);
 #endif
 #endif
+    GC_set_markers_count((unsigned)s_RequestedMarkerThreads);
 
 #if !RUNTIME_TINY
     default_push_other_roots = GC_get_push_other_roots();
@@ -171,12 +193,19 @@ void il2cpp::gc::GarbageCollector::UninitializeGC()
 int32_t
 il2cpp::gc::GarbageCollector::GetCollectionCount(int32_t generation)
 {
+    if (generation > 0 && GetMaxGeneration() > 0)
+        return (int32_t)GC_get_full_gc_no();
     return (int32_t)GC_get_gc_no();
 }
 
 int32_t
 il2cpp::gc::GarbageCollector::GetMaxGeneration()
 {
+#if IL2CPP_ENABLE_WRITE_BARRIERS
+    // Unity can turn incremental mode off at runtime, and partial collections go with it.
+    if (s_GenerationalMode && GC_is_incremental_mode())
+        return 1;
+#endif
     return 0;
 }
 
@@ -187,7 +216,10 @@ il2cpp::gc::GarbageCollector::Collect(int maxGeneration)
     if (GC_is_disabled())
         s_PendingGC = true;
 #endif
-    GC_gcollect();
+    if (maxGeneration < GetMaxGeneration())
+        GC_collect_minor();
+    else
+        GC_gcollect();
 }
 
 int32_t
@@ -209,6 +241,23 @@ il2cpp::gc::GarbageCollector::CollectALittle()
 #endif
 }
 
+int32_t
+il2cpp::gc::GarbageCollector::CollectALittle(int64_t budgetNs)
+{
+    if (budgetNs <= 0)
+        return CollectALittle();
+
+#if IL2CPP_ENABLE_DEFERRED_GC
+    if (s_PendingGC)
+    {
+        s_PendingGC = false;
+        GC_gcollect();
+        return 0; // no more work to do
+    }
+#endif
+    return GC_collect_a_little_ns((unsigned long long)budgetNs);
+}
+
 void
 il2cpp::gc::GarbageCollector::StartIncrementalCollection()
 {
@@ -296,6 +345,8 @@ il2cpp::gc::GarbageCollector::RegisterThread()
         /* Abort we can't scan the stack, so we can't use the GC */
         abort();
     }
+    // This also sets up the thread's local free lists, so that small
+    // allocations made from this thread do not take the GC allocation lock.
     res = GC_register_my_thread(&sb);
     if ((res != GC_SUCCESS) && (res != GC_DUPLICATE))
     {
@@ -335,7 +386,7 @@ void
 il2cpp::gc::GarbageCollector::AddWeakLink(void **link_addr, Il2CppObject *obj, bool track)
 {
     /* libgc requires that we use HIDE_POINTER... */
-    *link_addr = (void*)GC_HIDE_POINTER(obj);
+    os::Atomic::PublishPointer(link_addr, (void*)GC_HIDE_POINTER(obj));
     // need this since our strings are not real objects
     if (GC_is_heap_ptr(obj))
         GC_GENERAL_REGISTER_DISAPPEARING_LINK(link_addr, obj);
@@ -347,20 +398,15 @@ il2cpp::gc::GarbageCollector::RemoveWeakLink(void **link_addr)
     Il2CppObject*  obj = GarbageCollector::GetWeakLink(link_addr);
     if (GC_is_heap_ptr(obj))
         GC_unregister_disappearing_link(link_addr);
-    *link_addr = NULL;
-}
-
-static void*
-RevealLink(void* link_addr)
-{
-    void **link_a = (void**)link_addr;
-    return GC_REVEAL_POINTER(*link_a);
+    os::Atomic::PublishPointer(link_addr, (void*)NULL);
 }
 
 Il2CppObject*
 il2cpp::gc::GarbageCollector::GetWeakLink(void **link_addr)
 {
-    Il2CppObject *obj = (Il2CppObject*)GC_call_with_alloc_lock(RevealLink, link_addr);
+    // Only falls back to the allocation lock while a collection is clearing links, so weak
+    // handle reads from many threads do not serialize against allocation.
+    Il2CppObject *obj = (Il2CppObject*)GC_reveal_disappearing_link(link_addr);
     if (obj == (Il2CppObject*)-1)
         return NULL;
     return obj;
@@ -370,19 +416,14 @@ void*
 il2cpp::gc::GarbageCollector::MakeDescriptorForObject(size_t *bitmap, int numbits)
 {
 #ifdef GC_GCJ_SUPPORT
-    /* It seems there are issues when the bitmap doesn't fit: play it safe */
-    if (numbits >= 30)
-        return GC_NO_DESCRIPTOR;
-    else
-    {
-        GC_descr desc = GC_make_descriptor((GC_bitmap)bitmap, numbits);
-        // we should always have a GC_DS_BITMAP descriptor, as we:
-        // 1) Always want a precise marker.
-        // 2) Can never be GC_DS_LENGTH since we always have an object header
-        //    at the beginning of the allocation.
-        IL2CPP_ASSERT((desc & GC_DS_TAGS) == GC_DS_BITMAP || (desc & GC_DS_TAGS) == (GC_descr)GC_NO_DESCRIPTOR);
-        return (void*)desc;
-    }
+    // Layouts that fit in a single word get a GC_DS_BITMAP descriptor. Larger ones get an extended
+    // descriptor from typd_mlc.c: a GC_DS_PROC descriptor marked by GC_typed_mark_proc, which the
+    // gcj object kind picks up from the vtable like any other descriptor.
+    GC_descr desc = GC_make_descriptor((GC_bitmap)bitmap, numbits);
+    // GC_DS_LENGTH only comes back if the extended descriptor could not be allocated. That scans
+    // conservatively, which is still correct.
+    IL2CPP_ASSERT((desc & GC_DS_TAGS) == GC_DS_BITMAP || (desc & GC_DS_TAGS) == GC_DS_PROC || (desc & GC_DS_TAGS) == GC_DS_LENGTH);
+    return (void*)desc;
 #else
     return 0;
 #endif
@@ -487,6 +528,107 @@ il2cpp::gc::GarbageCollector::IsIncremental()
     return GC_is_incremental_mode();
 }
 
+int32_t
+il2cpp::gc::GarbageCollector::GetMarkerThreadCount()
+{
+    if (!s_GCInitialized)
+        return s_RequestedMarkerThreads;
+    return (int32_t)GC_get_active_markers_count();
+}
+
+void
+il2cpp::gc::GarbageCollector::SetMarkerThreadCount(int32_t count)
+{
+    if (count < 0)
+        count = 0;
+
+    // Before initialization this decides how many marker threads get started. Afterwards it can
+    // only limit how many of them take part in each mark phase; 0 lets all of them help again.
+    os::FastAutoLock lock(&s_GCSetModeLock);
+    if (!s_GCInitialized)
+        s_RequestedMarkerThreads = count;
+    else
+        GC_set_active_markers_count((unsigned)count);
+}
+
+// GC events are delivered with the allocation lock held, so only one thread touches these.
+static int64_t s_StopWorldStartUsecs;
+static int64_t s_MarkStartUsecs;
+static int64_t s_ReclaimStartUsecs;
+static uint64_t s_CollectionPauseUsecs;
+static GC_word s_LastFullGCNo;
+
+static int64_t GetTimeUsecs()
+{
+    return il2cpp::os::Time::GetTicks100NanosecondsMonotonic() / 10;
+}
+
+static GC_word GetHeapSizeUnsafe(GC_word* reclaimedBytes)
+{
+    struct GC_prof_stats_s stats;
+#if defined(GC_THREADS)
+    GC_get_prof_stats_unsafe(&stats, sizeof(stats));
+#else
+    GC_get_prof_stats(&stats, sizeof(stats));
+#endif
+    if (reclaimedBytes)
+        *reclaimedBytes = stats.bytes_reclaimed_since_gc;
+    return stats.heapsize_full - stats.unmapped_bytes;
+}
+
+static void record_gc_stats(GC_EventType eventType)
+{
+    switch (eventType)
+    {
+        case GC_EVENT_PRE_STOP_WORLD:
+            s_StopWorldStartUsecs = GetTimeUsecs();
+            break;
+        case GC_EVENT_POST_START_WORLD:
+        {
+            uint64_t pause = (uint64_t)(GetTimeUsecs() - s_StopWorldStartUsecs);
+            s_CollectionPauseUsecs += pause;
+            il2cpp_runtime_stats.gc_pause_usecs.Record(pause);
+            break;
+        }
+        case GC_EVENT_MARK_START:
+            s_MarkStartUsecs = GetTimeUsecs();
+            break;
+        case GC_EVENT_MARK_END:
+            il2cpp_runtime_stats.gc_mark_usecs.Record((uint64_t)(GetTimeUsecs() - s_MarkStartUsecs));
+            break;
+        case GC_EVENT_RECLAIM_START:
+            il2cpp_runtime_stats.gc_heap_size_before.Record(GetHeapSizeUnsafe(NULL));
+            s_ReclaimStartUsecs = GetTimeUsecs();
+            break;
+        case GC_EVENT_RECLAIM_END:
+        {
+            uint64_t sweep = (uint64_t)(GetTimeUsecs() - s_ReclaimStartUsecs);
+            GC_word reclaimed;
+            il2cpp_runtime_stats.gc_sweep_usecs.Record(sweep);
+            il2cpp_runtime_stats.gc_heap_size_after.Record(GetHeapSizeUnsafe(&reclaimed));
+            il2cpp_runtime_stats.gc_reclaimed_bytes.Record(reclaimed);
+
+            // A collection's time is its stop-the-world pauses plus the reclaim phase.
+            GC_word fullGCNo = GC_get_full_gc_no();
+            if (fullGCNo != s_LastFullGCNo)
+            {
+                s_LastFullGCNo = fullGCNo;
+                ++il2cpp_runtime_stats.major_gc_count;
+                il2cpp_runtime_stats.major_gc_time_usecs += s_CollectionPauseUsecs + sweep;
+            }
+            else
+            {
+                ++il2cpp_runtime_stats.minor_gc_count;
+                il2cpp_runtime_stats.minor_gc_time_usecs += s_CollectionPauseUsecs + sweep;
+            }
+            s_CollectionPauseUsecs = 0;
+            break;
+        }
+        default:
+            break;
+    }
+}
+
 void on_gc_event(GC_EventType eventType)
 {
 #if !RUNTIME_TINY
@@ -495,6 +637,7 @@ void on_gc_event(GC_EventType eventType)
         clear_ephemerons();
     }
 #endif
+    record_gc_stats(eventType);
 #if IL2CPP_ENABLE_PROFILER
     Profiler::GCEvent((Il2CppGCEvent)eventType);
 #endif
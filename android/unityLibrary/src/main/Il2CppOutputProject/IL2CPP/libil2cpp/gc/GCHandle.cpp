@@ -2,53 +2,79 @@
 #include "gc/GCHandle.h"
 #include "il2cpp-object-internals.h"
 #include "GarbageCollector.h"
+#include "os/Atomic.h"
 #include "os/Mutex.h"
 #include "utils/Memory.h"
+#include "Cpp/Algorithm.h"
 #include <memory>
 
 namespace il2cpp
 {
 namespace gc
 {
+/* Handle entries live in buckets that never move once allocated: bucket k holds (32 << k) entries.
+ * This lets GetTarget read handles of every type without taking any lock, and lets the weak tables grow
+ * without re-registering the disappearing link of every existing entry. 24 buckets cover every
+ * slot that can be encoded in a handle.
+ */
+#define HANDLE_BUCKET_COUNT 24
+
     typedef struct
     {
         uint32_t  *bitmap;
-        void* *entries;
         uint32_t   size;
         uint8_t    type;
         uint32_t     slot_hint : 24;/* starting slot for search */
-        /* 2^16 appdomains should be enough for everyone (though I know I'll regret this in 20 years) */
-        /* we alloc this only for weak refs, since we can get the domain directly in the other cases */
-        uint16_t  *domain_ids;
+        void* *buckets[HANDLE_BUCKET_COUNT];
     } HandleData;
 
-/* weak and weak-track arrays will be allocated in malloc memory
+/* weak and weak-track buckets will be allocated in malloc memory
  */
     static HandleData gc_handles[] =
     {
-        {NULL, NULL, 0, HANDLE_WEAK, 0},
-        {NULL, NULL, 0, HANDLE_WEAK_TRACK, 0},
-        {NULL, NULL, 0, HANDLE_NORMAL, 0},
-        {NULL, NULL, 0, HANDLE_PINNED, 0}
+        {NULL, 0, HANDLE_WEAK, 0},
+        {NULL, 0, HANDLE_WEAK_TRACK, 0},
+        {NULL, 0, HANDLE_NORMAL, 0},
+        {NULL, 0, HANDLE_PINNED, 0}
     };
 
 
-    static int
+    static inline int
     find_first_unset(uint32_t bitmap)
     {
-        int i;
-        for (i = 0; i < 32; ++i)
-        {
-            if (!(bitmap & (1 << i)))
-                return i;
-        }
-        return -1;
+        return baselib::Algorithm::LowestBit(~bitmap);
+    }
+
+    static inline uint32_t
+    handle_bucket_index(uint32_t slot)
+    {
+        return baselib::Algorithm::HighestBitNonZero(slot / 32 + 1);
+    }
+
+    static inline uint32_t
+    handle_bucket_start(uint32_t bucket)
+    {
+        return 32 * ((1U << bucket) - 1);
+    }
+
+    static inline uint32_t
+    handle_bucket_size(uint32_t bucket)
+    {
+        return 32U << bucket;
+    }
+
+    static inline void**
+    handle_entry(HandleData *handles, uint32_t slot)
+    {
+        uint32_t bucket = handle_bucket_index(slot);
+        return &handles->buckets[bucket][slot - handle_bucket_start(bucket)];
     }
 
-    static baselib::ReentrantLock g_HandlesMutex;
+    /* one lock per handle type, so that e.g. weak reference churn does not contend with pinning */
+    static baselib::ReentrantLock g_HandlesMutex[HANDLE_PINNED + 1];
 
-#define lock_handles(handles) g_HandlesMutex.Acquire ()
-#define unlock_handles(handles) g_HandlesMutex.Release ()
+#define lock_handles(handles) g_HandlesMutex[(handles)->type].Acquire ()
+#define unlock_handles(handles) g_HandlesMutex[(handles)->type].Release ()
 
     static uint32_t
     alloc_handle(HandleData *handles, Il2CppObject *obj, bool track)
@@ -56,20 +82,6 @@ namespace gc
         uint32_t slot;
         int i;
         lock_handles(handles);
-        if (!handles->size)
-        {
-            handles->size = 32;
-            if (handles->type > HANDLE_WEAK_TRACK)
-            {
-                handles->entries = (void**)GarbageCollector::AllocateFixed(sizeof(void*) * handles->size, NULL);
-            }
-            else
-            {
-                handles->entries = (void**)IL2CPP_MALLOC_ZERO(sizeof(void*) * handles->size);
-                handles->domain_ids = (uint16_t*)IL2CPP_MALLOC_ZERO(sizeof(uint16_t) * handles->size);
-            }
-            handles->bitmap = (uint32_t*)IL2CPP_MALLOC_ZERO(handles->size / 8);
-        }
         i = -1;
         for (slot = handles->slot_hint; slot < handles->size / 32; ++slot)
         {
@@ -95,71 +107,46 @@ namespace gc
         if (i == -1)
         {
             uint32_t *new_bitmap;
-            uint32_t new_size = handles->size * 2; /* always double: we memset to 0 based on this below */
+            uint32_t new_size;
+            void* *entries;
+
+            /* add the next bucket; existing entries and their weak links stay where they are */
+            uint32_t bucket = handle_bucket_index(handles->size);
+            IL2CPP_ASSERT(bucket < HANDLE_BUCKET_COUNT);
+            new_size = handles->size + handle_bucket_size(bucket);
 
             /* resize and copy the bitmap */
             new_bitmap = (uint32_t*)IL2CPP_MALLOC_ZERO(new_size / 8);
-            memcpy(new_bitmap, handles->bitmap, handles->size / 8);
+            if (handles->bitmap)
+                memcpy(new_bitmap, handles->bitmap, handles->size / 8);
             IL2CPP_FREE(handles->bitmap);
             handles->bitmap = new_bitmap;
 
-            /* resize and copy the entries */
             if (handles->type > HANDLE_WEAK_TRACK)
-            {
-                void* *entries;
-                entries = (void**)GarbageCollector::AllocateFixed(sizeof(void*) * new_size, NULL);
-                memcpy(entries, handles->entries, sizeof(void*) * handles->size);
-
-                GarbageCollector::SetWriteBarrier(entries, sizeof(void*) * handles->size);
-
-                void** previous_entries = handles->entries;
-                handles->entries = entries;
-                GarbageCollector::FreeFixed(previous_entries);
-            }
+                entries = (void**)GarbageCollector::AllocateFixed(sizeof(void*) * handle_bucket_size(bucket), NULL);
             else
-            {
-                void* *entries;
-                uint16_t *domain_ids;
-                domain_ids = (uint16_t*)IL2CPP_MALLOC_ZERO(sizeof(uint16_t) * new_size);
-                entries = (void**)IL2CPP_MALLOC(sizeof(void*) * new_size);
-                /* we disable GC because we could lose some disappearing link updates */
-                GarbageCollector::Disable();
-                memcpy(entries, handles->entries, sizeof(void*) * handles->size);
-                memset(entries + handles->size, 0, sizeof(void*) * handles->size);
-                memcpy(domain_ids, handles->domain_ids, sizeof(uint16_t) * handles->size);
-                for (i = 0; i < (int32_t)handles->size; ++i)
-                {
-                    Il2CppObject *obj = GarbageCollector::GetWeakLink(&(handles->entries[i]));
-                    if (handles->entries[i])
-                        GarbageCollector::RemoveWeakLink(&(handles->entries[i]));
-                    /*g_print ("reg/unreg entry %d of type %d at %p to object %p (%p), was: %p\n", i, handles->type, &(entries [i]), obj, entries [i], handles->entries [i]);*/
-                    if (obj)
-                    {
-                        GarbageCollector::AddWeakLink(&(entries[i]), obj, track);
-                    }
-                }
-                IL2CPP_FREE(handles->entries);
-                IL2CPP_FREE(handles->domain_ids);
-                handles->entries = entries;
-                handles->domain_ids = domain_ids;
-                GarbageCollector::Enable();
-            }
+                entries = (void**)IL2CPP_MALLOC_ZERO(sizeof(void*) * handle_bucket_size(bucket));
+            os::Atomic::PublishPointer(&handles->buckets[bucket], entries);
 
             /* set i and slot to the next free position */
             i = 0;
-            slot = (handles->size + 1) / 32;
-            handles->slot_hint = handles->size + 1;
+            slot = handles->size / 32;
+            handles->slot_hint = slot;
             handles->size = new_size;
         }
-        handles->bitmap[slot] |= 1 << i;
+        handles->bitmap[slot] |= 1U << i;
         slot = slot * 32 + i;
-        handles->entries[slot] = obj;
-        GarbageCollector::SetWriteBarrier(handles->entries + slot);
-
+        void** entry = handle_entry(handles, slot);
         if (handles->type <= HANDLE_WEAK_TRACK)
         {
+            os::Atomic::PublishPointer(entry, (void*)obj);
             if (obj)
-                GarbageCollector::AddWeakLink(&(handles->entries[slot]), obj, track);
+                GarbageCollector::AddWeakLink(entry, obj, track);
+        }
+        else
+        {
+            os::Atomic::PublishPointer(entry, (void*)obj);
+            GarbageCollector::SetWriteBarrier(entry);
         }
 
         //mono_perfcounters->gc_num_handles++;
@@ -203,23 +190,21 @@ namespace gc
         Il2CppObject *obj = NULL;
         if (type > 3)
             return NULL;
-        lock_handles(handles);
-        if (slot < handles->size && (handles->bitmap[slot / 32] & (1 << (slot % 32))))
-        {
-            if (handles->type <= HANDLE_WEAK_TRACK)
-            {
-                obj = GarbageCollector::GetWeakLink(&handles->entries[slot]);
-            }
-            else
-            {
-                obj = (Il2CppObject*)handles->entries[slot];
-            }
-        }
+
+        /* Entries never move, and Free clears a slot (unregistering its weak link first) before the
+         * slot can be handed out again, so no lock is needed. A cleared weak entry reads as NULL. */
+        uint32_t bucket = handle_bucket_index(slot);
+        if (bucket >= HANDLE_BUCKET_COUNT)
+            return NULL;
+        void** entries = os::Atomic::ReadPointer(&handles->buckets[bucket]);
+        if (entries == NULL)
+            return NULL;
+        void** entry = &entries[slot - handle_bucket_start(bucket)];
+
+        if (type > HANDLE_WEAK_TRACK)
+            obj = (Il2CppObject*)os::Atomic::ReadPointer(entry);
         else
-        {
-            /* print a warning? */
-        }
-        unlock_handles(handles);
+            obj = GarbageCollector::GetWeakLink(entry);
         /*g_print ("get target of entry %d of type %d: %p\n", slot, handles->type, obj);*/
         return obj;
     }
@@ -235,19 +220,21 @@ namespace gc
         if (type > 3)
             return;
         lock_handles(handles);
-        if (slot < handles->size && (handles->bitmap[slot / 32] & (1 << (slot % 32))))
+        if (slot < handles->size && (handles->bitmap[slot / 32] & (1U << (slot % 32))))
         {
+            void** entry = handle_entry(handles, slot);
             if (handles->type <= HANDLE_WEAK_TRACK)
             {
-                old_obj = (Il2CppObject*)handles->entries[slot];
-                if (handles->entries[slot])
-                    GarbageCollector::RemoveWeakLink(&handles->entries[slot]);
+                old_obj = (Il2CppObject*)*entry;
+                if (*entry)
+                    GarbageCollector::RemoveWeakLink(entry);
                 if (obj)
-                    GarbageCollector::AddWeakLink(&handles->entries[slot], obj, handles->type == HANDLE_WEAK_TRACK);
+                    GarbageCollector::AddWeakLink(entry, obj, handles->type == HANDLE_WEAK_TRACK);
             }
             else
             {
-                handles->entries[slot] = obj;
+                os::Atomic::PublishPointer(entry, (void*)obj);
+                GarbageCollector::SetWriteBarrier(entry);
             }
         }
         else
@@ -275,18 +262,19 @@ namespace gc
 #endif
 
         lock_handles(handles);
-        if (slot < handles->size && (handles->bitmap[slot / 32] & (1 << (slot % 32))))
+        if (slot < handles->size && (handles->bitmap[slot / 32] & (1U << (slot % 32))))
         {
+            void** entry = handle_entry(handles, slot);
             if (handles->type <= HANDLE_WEAK_TRACK)
             {
-                if (handles->entries[slot])
-                    GarbageCollector::RemoveWeakLink(&handles->entries[slot]);
+                if (*entry)
+                    GarbageCollector::RemoveWeakLink(entry);
             }
             else
             {
-                handles->entries[slot] = NULL;
+                os::Atomic::PublishPointer(entry, (void*)NULL);
             }
-            handles->bitmap[slot / 32] &= ~(1 << (slot % 32));
+            handles->bitmap[slot / 32] &= ~(1U << (slot % 32));
         }
         else
         {
@@ -323,20 +311,24 @@ namespace gc
 
     void GCHandle::WalkStrongGCHandleTargets(WalkGCHandleTargetsCallback callback, void* context)
     {
-        lock_handles(handles);
         const GCHandleType types[] = { HANDLE_NORMAL, HANDLE_PINNED };
 
         for (int gcHandleTypeIndex = 0; gcHandleTypeIndex < 2; gcHandleTypeIndex++)
         {
-            const HandleData& handles = gc_handles[types[gcHandleTypeIndex]];
+            HandleData* handles = &gc_handles[types[gcHandleTypeIndex]];
 
-            for (uint32_t i = 0; i < handles.size; i++)
+            lock_handles(handles);
+            for (uint32_t bucket = 0; bucket < HANDLE_BUCKET_COUNT && handles->buckets[bucket] != NULL; bucket++)
             {
-                if (handles.entries[i] != NULL)
-                    callback(static_cast<Il2CppObject*>(handles.entries[i]), context);
+                void** entries = handles->buckets[bucket];
+                for (uint32_t i = 0; i < handle_bucket_size(bucket); i++)
+                {
+                    if (entries[i] != NULL)
+                        callback(static_cast<Il2CppObject*>(entries[i]), context);
+                }
             }
+            unlock_handles(handles);
         }
-        unlock_handles(handles);
     }
 } /* gc */
 } /* il2cpp */
@@ -14,6 +14,8 @@ namespace gc
     public:
         static void Collect(int maxGeneration);
         static int32_t CollectALittle();
+        // Marks for up to budgetNs nanoseconds; returns non-zero while the collection has work left.
+        static int32_t CollectALittle(int64_t budgetNs);
         static int32_t GetCollectionCount(int32_t generation);
         static int64_t GetUsedHeapSize();
 #if IL2CPP_ENABLE_WRITE_BARRIERS
@@ -64,6 +66,9 @@ namespace gc
         static int64_t GetMaxTimeSliceNs();
         static void SetMaxTimeSliceNs(int64_t maxTimeSlice);
 
+        static int32_t GetMarkerThreadCount();
+        static void SetMarkerThreadCount(int32_t count);
+
         static FinalizerCallback RegisterFinalizerWithCallback(Il2CppObject* obj, FinalizerCallback callback);
 
         static int64_t GetAllocatedHeapSize();
@@ -112,6 +112,12 @@ il2cpp::gc::GarbageCollector::CollectALittle()
     return 0;
 }
 
+int32_t
+il2cpp::gc::GarbageCollector::CollectALittle(int64_t budgetNs)
+{
+    return 0;
+}
+
 void
 il2cpp::gc::GarbageCollector::StartIncrementalCollection()
 {
@@ -193,4 +199,15 @@ il2cpp::gc::GarbageCollector::IsIncremental()
     return false;
 }
 
+int32_t
+il2cpp::gc::GarbageCollector::GetMarkerThreadCount()
+{
+    return 1;
+}
+
+void
+il2cpp::gc::GarbageCollector::SetMarkerThreadCount(int32_t count)
+{
+}
+
 #endif
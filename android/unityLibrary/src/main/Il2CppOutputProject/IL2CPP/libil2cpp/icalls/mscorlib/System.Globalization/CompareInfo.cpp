@@ -12,6 +12,15 @@
 #include <cwctype>
 #include <wctype.h>
 #include <algorithm>
+#include "Cpp/Algorithm.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IL2CPP_COMPARE_INFO_USE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define IL2CPP_COMPARE_INFO_USE_NEON 1
+#include <arm_neon.h>
+#endif
 
 namespace il2cpp
 {
@@ -23,95 +32,184 @@ namespace System
 {
 namespace Globalization
 {
-    static int string_invariant_compare_char(Il2CppChar c1, Il2CppChar c2, int options)
+    // Returns the index of the first character that differs between the two buffers, or length if
+    // they are equal. Compares eight UTF-16 characters at a time where SIMD is available.
+    static int32_t FindFirstMismatch(const Il2CppChar* str1, const Il2CppChar* str2, int32_t length)
     {
-        int result = 0;
+        int32_t pos = 0;
 
-        // Ordinal can not be mixed with other options, and must return the difference, not only -1, 0, 1.
-        if (options & CompareOptions_Ordinal)
-            return (int)(c1 - c2);
+#if IL2CPP_COMPARE_INFO_USE_SSE2
+        for (; pos + 8 <= length; pos += 8)
+        {
+            __m128i chars1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str1 + pos));
+            __m128i chars2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str2 + pos));
+            uint32_t equalMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(chars1, chars2)));
+            if (equalMask != 0xFFFF)
+                return pos + baselib::Algorithm::LowestBitNonZero(~equalMask & 0xFFFF) / 2;
+        }
+#elif IL2CPP_COMPARE_INFO_USE_NEON
+        for (; pos + 8 <= length; pos += 8)
+        {
+            uint16x8_t chars1 = vld1q_u16(reinterpret_cast<const uint16_t*>(str1 + pos));
+            uint16x8_t chars2 = vld1q_u16(reinterpret_cast<const uint16_t*>(str2 + pos));
+            uint8x8_t equal = vmovn_u16(vceqq_u16(chars1, chars2));
+            uint64_t equalMask = vget_lane_u64(vreinterpret_u64_u8(equal), 0);
+            if (equalMask != UINT64_MAX)
+                return pos + baselib::Algorithm::LowestBitNonZero(~equalMask) / 8;
+        }
+#endif
 
-        if (options & CompareOptions_IgnoreCase)
+        for (; pos < length; pos++)
         {
-            result = towlower(c1) - towlower(c2);
+            if (str1[pos] != str2[pos])
+                return pos;
+        }
+
+        return length;
+    }
+
+    // Returns the index of the first occurrence of c in the buffer, or -1.
+    static int32_t FindChar(const Il2CppChar* str, int32_t length, Il2CppChar c)
+    {
+        int32_t pos = 0;
+
+#if IL2CPP_COMPARE_INFO_USE_SSE2
+        const __m128i pattern = _mm_set1_epi16(static_cast<short>(c));
+        for (; pos + 8 <= length; pos += 8)
+        {
+            __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + pos));
+            uint32_t matchMask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi16(chars, pattern)));
+            if (matchMask != 0)
+                return pos + baselib::Algorithm::LowestBitNonZero(matchMask) / 2;
+        }
+#elif IL2CPP_COMPARE_INFO_USE_NEON
+        const uint16x8_t pattern = vdupq_n_u16(static_cast<uint16_t>(c));
+        for (; pos + 8 <= length; pos += 8)
+        {
+            uint16x8_t chars = vld1q_u16(reinterpret_cast<const uint16_t*>(str + pos));
+            uint8x8_t match = vmovn_u16(vceqq_u16(chars, pattern));
+            uint64_t matchMask = vget_lane_u64(vreinterpret_u64_u8(match), 0);
+            if (matchMask != 0)
+                return pos + baselib::Algorithm::LowestBitNonZero(matchMask) / 8;
+        }
+#endif
+
+        for (; pos < length; pos++)
+        {
+            if (str[pos] == c)
+                return pos;
+        }
+
+        return -1;
+    }
+
+    static inline int32_t CompareLengths(int32_t length1, int32_t length2)
+    {
+        return (length1 < length2) ? -1 : (length1 > length2) ? 1 : 0;
+    }
+
+    static inline int32_t CompareCharIgnoreCase(Il2CppChar c1, Il2CppChar c2)
+    {
+        int result;
+        if (c1 < 0x80 && c2 < 0x80)
+        {
+            // ASCII fast path, avoids the towlower call.
+            int lower1 = (c1 >= 'A' && c1 <= 'Z') ? (c1 | 0x20) : c1;
+            int lower2 = (c2 >= 'A' && c2 <= 'Z') ? (c2 | 0x20) : c2;
+            result = lower1 - lower2;
         }
         else
         {
-            /*
-             * No options. Kana, symbol and spacing options don't
-             * apply to the invariant culture.
-             */
-
-            /*
-             * FIXME: here we must use the information from c1type and c2type
-             * to find out the proper collation, even on the InvariantCulture, the
-             * sorting is not done by computing the unicode values, but their
-             * actual sort order.
-             */
-            result = (int)(c1 - c2);
+            result = towlower(c1) - towlower(c2);
         }
 
         return ((result < 0) ? -1 : (result > 0) ? 1 : 0);
     }
 
-    int32_t CompareInfo::internal_compare_icall(Il2CppChar* str1, int32_t length1, Il2CppChar* str2, int32_t length2, int32_t options)
+    static int32_t CompareIgnoreCase(const Il2CppChar* str1, int32_t length1, const Il2CppChar* str2, int32_t length2)
     {
-        // Do a normal ascii string compare, as we only know the invariant locale if we dont have ICU.
-        /* c translation of C# code from old string.cs.. :) */
-        const int length = std::max(length1, length2);
-        int charcmp;
-        int pos = 0;
+        const int32_t length = std::min(length1, length2);
 
-        for (pos = 0; pos != length; pos++)
+        // Skip over runs of identical characters and only case fold where the strings differ.
+        int32_t pos = 0;
+        while (true)
         {
-            if (pos >= length1 || pos >= length2)
-                break;
+            pos += FindFirstMismatch(str1 + pos, str2 + pos, length - pos);
+            if (pos == length)
+                return CompareLengths(length1, length2);
+
+            int32_t result = CompareCharIgnoreCase(str1[pos], str2[pos]);
+            if (result != 0)
+                return result;
 
-            charcmp = string_invariant_compare_char(str1[pos], str2[pos],
-                options);
-            if (charcmp != 0)
-                return (charcmp);
+            pos++;
         }
+    }
 
-        /* the lesser wins, so if we have looped until length we just
-         * need to check the last char
+    int32_t CompareInfo::internal_compare_icall(Il2CppChar* str1, int32_t length1, Il2CppChar* str2, int32_t length2, int32_t options)
+    {
+        // Do a normal ascii string compare, as we only know the invariant locale if we dont have ICU.
+        // Ordinal can not be mixed with other options.
+        const bool ordinal = (options & CompareOptions_Ordinal) != 0;
+        if (!ordinal && (options & CompareOptions_IgnoreCase))
+            return CompareIgnoreCase(str1, length1, str2, length2);
+
+        /*
+         * No options. Kana, symbol and spacing options don't
+         * apply to the invariant culture.
+         *
+         * FIXME: here we must use the information from c1type and c2type
+         * to find out the proper collation, even on the InvariantCulture, the
+         * sorting is not done by computing the unicode values, but their
+         * actual sort order.
          */
+        const int32_t length = std::min(length1, length2);
+        const int32_t pos = FindFirstMismatch(str1, str2, length);
+
+        /* the lesser wins */
         if (pos == length)
-            return (string_invariant_compare_char(str1[pos - 1], str2[pos - 1], options));
+            return CompareLengths(length1, length2);
 
-        /* Test if one of the strings has been compared to the end */
-        if (pos >= length1)
-        {
-            if (pos >= length2)
-                return (0);
-            return (-1);
-        }
-        else if (pos >= length2)
-            return (1);
+        // Ordinal must return the difference, not only -1, 0, 1.
+        const int32_t result = (int32_t)(str1[pos] - str2[pos]);
+        if (ordinal)
+            return result;
 
-        /* if not, check our last char only.. (can this happen?) */
-        return (string_invariant_compare_char(str1[pos], str2[pos], options));
+        return (result < 0) ? -1 : 1;
     }
 
     int32_t CompareInfo::internal_index_icall(Il2CppChar* source, int32_t sindex, int32_t count, Il2CppChar* value, int32_t value_length, bool first)
     {
-        int pos, i;
+        if (value_length <= 0)
+            return sindex;
+
+        const Il2CppChar firstChar = value[0];
+        const size_t remainingValueSize = (value_length - 1) * sizeof(Il2CppChar);
 
         if (first)
         {
-            count -= value_length;
-            for (pos = sindex; pos <= sindex + count; pos++)
-                for (i = 0; source[pos + i] == value[i];)
-                    if (++i == value_length)
-                        return (pos);
+            // Scan for the first character of the value and only compare the rest at candidate positions.
+            const int32_t lastPos = sindex + count - value_length;
+            for (int32_t pos = sindex; pos <= lastPos; pos++)
+            {
+                int32_t offset = FindChar(source + pos, lastPos - pos + 1, firstChar);
+                if (offset < 0)
+                    return (-1);
+
+                pos += offset;
+                if (memcmp(source + pos + 1, value + 1, remainingValueSize) == 0)
+                    return (pos);
+            }
 
             return (-1);
         }
         else
         {
-            for (pos = sindex - value_length + 1; pos > sindex - count; pos--)
-                if (memcmp(source + pos, value, value_length * sizeof(Il2CppChar)) == 0)
+            for (int32_t pos = sindex - value_length + 1; pos > sindex - count; pos--)
+            {
+                if (source[pos] == firstChar && memcmp(source + pos + 1, value + 1, remainingValueSize) == 0)
                     return (pos);
+            }
 
             return (-1);
         }
@@ -5,6 +5,8 @@
 #include "il2cpp-class-internals.h"
 #include "il2cpp-object-internals.h"
 #include "gc/WriteBarrier.h"
+#include "os/Atomic.h"
+#include "utils/Memory.h"
 #include "utils/StringUtils.h"
 #include "utils/HashUtils.h"
 #include "vm/Array.h"
@@ -14,8 +16,47 @@
 #include "vm/Object.h"
 #include "vm/String.h"
 
+#include <vector>
+
 using il2cpp::gc::WriteBarrier;
 
+struct Il2CppValueTypeFieldPlanEntry
+{
+    enum Kind
+    {
+        kRawBytes, // primitives, enums and nested value types using the default Equals/GetHashCode
+        kSingle,
+        kDouble,
+        kString,
+        kReference, // reference type field, only decided natively when null or identical
+        kBoxed // everything else goes through the managed Equals/GetHashCode of the boxed field
+    };
+
+    uint32_t kind;
+    uint32_t offset;
+    uint32_t size; // kRawBytes only
+    FieldInfo* field; // kReference and kBoxed only
+};
+
+#if IL2CPP_COMPILER_MSVC
+#pragma warning( push )
+#pragma warning( disable : 4200 )
+#endif
+
+// Precomputed, flattened list of the instance fields of a value type describing how to compare and
+// hash them without reflection or boxing. Adjacent raw byte ranges are merged, so a blittable struct
+// without padding ends up as a single memcmp.
+struct Il2CppValueTypeEqualityPlan
+{
+    uint32_t entryCount;
+    bool hasManagedFields; // has kReference or kBoxed entries
+    Il2CppValueTypeFieldPlanEntry entries[IL2CPP_ZERO_LEN_ARRAY];
+};
+
+#if IL2CPP_COMPILER_MSVC
+#pragma warning( pop )
+#endif
+
 namespace il2cpp
 {
 namespace icalls
@@ -24,114 +65,285 @@ namespace mscorlib
 {
 namespace System
 {
-    bool ValueType::InternalEquals(Il2CppObject * thisPtr, Il2CppObject * that, Il2CppArray** fields)
+    typedef Il2CppValueTypeFieldPlanEntry PlanEntry;
+    typedef std::vector<PlanEntry> PlanEntries;
+
+    static const Il2CppValueTypeEqualityPlan* GetEqualityPlan(Il2CppClass* klass);
+
+    static void AddRawBytes(PlanEntries& entries, uint32_t offset, uint32_t size)
     {
-        Il2CppClass *klass;
-        Il2CppObject **values = NULL;
-        Il2CppObject *o;
-        FieldInfo* field;
-        void* iter;
-        int count = 0;
+        if (!entries.empty())
+        {
+            PlanEntry& last = entries.back();
+            if (last.kind == PlanEntry::kRawBytes && last.offset + last.size == offset)
+            {
+                last.size += size;
+                return;
+            }
+        }
 
-        IL2CPP_CHECK_ARG_NULL(that);
+        PlanEntry entry = { PlanEntry::kRawBytes, offset, size, NULL };
+        entries.push_back(entry);
+    }
 
-        if (thisPtr->klass != that->klass)
-            return false;
+    static void AddEntry(PlanEntries& entries, PlanEntry::Kind kind, uint32_t offset, FieldInfo* field)
+    {
+        PlanEntry entry = { static_cast<uint32_t>(kind), offset, 0, field };
+        entries.push_back(entry);
+    }
 
-        klass = vm::Object::GetClass(thisPtr);
+    static bool UsesDefaultValueTypeEquality(Il2CppClass* klass)
+    {
+        static int32_t s_EqualsSlot = -1;
+        static int32_t s_GetHashCodeSlot = -1;
+        if (s_EqualsSlot == -1)
+        {
+            s_GetHashCodeSlot = vm::Class::GetMethodFromName(il2cpp_defaults.object_class, "GetHashCode", 0)->slot;
+            s_EqualsSlot = vm::Class::GetMethodFromName(il2cpp_defaults.object_class, "Equals", 1)->slot;
+        }
 
-        if (klass->enumtype && vm::Class::GetEnumBaseType(klass) && vm::Class::GetEnumBaseType(klass)->type == IL2CPP_TYPE_I4)
-            return (*(int32_t*)((uint8_t*)thisPtr + sizeof(Il2CppObject)) == *(int32_t*)((uint8_t*)that + sizeof(Il2CppObject)));
+        return klass->vtable[s_EqualsSlot].method->klass == il2cpp_defaults.value_type_class
+            && klass->vtable[s_GetHashCodeSlot].method->klass == il2cpp_defaults.value_type_class;
+    }
 
-        /*
-         * Do the comparison for fields of primitive type and return a result if
-         * possible. Otherwise, return the remaining fields in an array to the
-         * managed side. This way, we can avoid costly reflection operations in
-         * managed code.
-         */
-        *fields = NULL;
-        iter = NULL;
+    // Appends the plan entries for the instance fields of klass. baseOffset is the offset at which the
+    // fields of klass start relative to the boxed object being compared.
+    static void BuildEqualityPlan(Il2CppClass* klass, uint32_t baseOffset, PlanEntries& entries)
+    {
+        FieldInfo* field;
+        void* iter = NULL;
         while ((field = vm::Class::GetFields(klass, &iter)))
         {
             if (field->type->attrs & FIELD_ATTRIBUTE_STATIC)
                 continue;
             if (vm::Field::IsDeleted(field))
                 continue;
-            /* FIXME: Add more types */
 
+            const uint32_t offset = baseOffset + field->offset - sizeof(Il2CppObject);
             switch (field->type->type)
             {
+                case IL2CPP_TYPE_BOOLEAN:
                 case IL2CPP_TYPE_I1:
                 case IL2CPP_TYPE_U1:
-                case IL2CPP_TYPE_BOOLEAN:
-                    if (*((uint8_t*)thisPtr + field->offset) != *((uint8_t*)that + field->offset))
-                        return false;
+                    AddRawBytes(entries, offset, 1);
                     break;
+                case IL2CPP_TYPE_CHAR:
                 case IL2CPP_TYPE_I2:
                 case IL2CPP_TYPE_U2:
-                case IL2CPP_TYPE_CHAR:
-                    if (*(int16_t*)((uint8_t*)thisPtr + field->offset) != *(int16_t*)((uint8_t*)that + field->offset))
-                        return false;
+                    AddRawBytes(entries, offset, 2);
                     break;
                 case IL2CPP_TYPE_I4:
                 case IL2CPP_TYPE_U4:
-                    if (*(int32_t*)((uint8_t*)thisPtr + field->offset) != *(int32_t*)((uint8_t*)that + field->offset))
-                        return false;
+                    AddRawBytes(entries, offset, 4);
                     break;
                 case IL2CPP_TYPE_I8:
                 case IL2CPP_TYPE_U8:
-                    if (*(int64_t*)((uint8_t*)thisPtr + field->offset) != *(int64_t*)((uint8_t*)that + field->offset))
-                        return false;
+                    AddRawBytes(entries, offset, 8);
+                    break;
+                case IL2CPP_TYPE_I:
+                case IL2CPP_TYPE_U:
+                case IL2CPP_TYPE_PTR:
+                case IL2CPP_TYPE_FNPTR:
+                    AddRawBytes(entries, offset, sizeof(void*));
                     break;
                 case IL2CPP_TYPE_R4:
-                    if (*(float*)((uint8_t*)thisPtr + field->offset) != *(float*)((uint8_t*)that + field->offset))
-                        return false;
+                    AddEntry(entries, PlanEntry::kSingle, offset, NULL);
                     break;
                 case IL2CPP_TYPE_R8:
-                    if (*(double*)((uint8_t*)thisPtr + field->offset) != *(double*)((uint8_t*)that + field->offset))
-                        return false;
-                    break;
-                case IL2CPP_TYPE_PTR:
-                    if (*(void**)((uint8_t*)thisPtr + field->offset) != *(void**)((uint8_t*)that + field->offset))
-                        return false;
+                    AddEntry(entries, PlanEntry::kDouble, offset, NULL);
                     break;
                 case IL2CPP_TYPE_STRING:
-                    Il2CppString *s1, *s2;
-                    uint32_t s1len, s2len;
-                    s1 = *(Il2CppString**)((uint8_t*)thisPtr + field->offset);
-                    s2 = *(Il2CppString**)((uint8_t*)that + field->offset);
-                    if (s1 == s2)
+                    AddEntry(entries, PlanEntry::kString, offset, NULL);
+                    break;
+                case IL2CPP_TYPE_VALUETYPE:
+                case IL2CPP_TYPE_GENERICINST:
+                {
+                    Il2CppClass* fieldClass = vm::Class::FromIl2CppType(field->type);
+                    if (!vm::Class::IsValuetype(fieldClass))
+                    {
+                        AddEntry(entries, PlanEntry::kReference, offset, field);
                         break;
-                    if ((s1 == NULL) || (s2 == NULL))
-                        return false;
-                    s1len = utils::StringUtils::GetLength(s1);
-                    s2len = utils::StringUtils::GetLength(s2);
-                    if (s1len != s2len)
-                        return false;
+                    }
 
-                    if (memcmp(utils::StringUtils::GetChars(s1), utils::StringUtils::GetChars(s2), s1len * sizeof(Il2CppChar)) != 0)
-                        return false;
+                    vm::Class::Init(fieldClass);
+                    const Il2CppValueTypeEqualityPlan* fieldPlan = GetEqualityPlan(fieldClass);
+                    if ((fieldClass->enumtype || UsesDefaultValueTypeEquality(fieldClass)) && !fieldPlan->hasManagedFields)
+                    {
+                        // Nested struct compared field by field anyway. Inline its plan.
+                        for (uint32_t i = 0; i < fieldPlan->entryCount; ++i)
+                        {
+                            const PlanEntry& fieldEntry = fieldPlan->entries[i];
+                            if (fieldEntry.kind == PlanEntry::kRawBytes)
+                                AddRawBytes(entries, offset + fieldEntry.offset - sizeof(Il2CppObject), fieldEntry.size);
+                            else
+                                AddEntry(entries, static_cast<PlanEntry::Kind>(fieldEntry.kind), offset + fieldEntry.offset - sizeof(Il2CppObject), NULL);
+                        }
+                    }
+                    else
+                    {
+                        AddEntry(entries, PlanEntry::kBoxed, offset, field);
+                    }
+                    break;
+                }
+                case IL2CPP_TYPE_CLASS:
+                case IL2CPP_TYPE_OBJECT:
+                case IL2CPP_TYPE_ARRAY:
+                case IL2CPP_TYPE_SZARRAY:
+                    AddEntry(entries, PlanEntry::kReference, offset, field);
                     break;
                 default:
-                    if (!values)
-                        values = (Il2CppObject**)alloca(sizeof(Il2CppObject*) * (vm::Class::GetNumFields(klass) * 2));
-                    o = vm::Field::GetValueObject(field, thisPtr);
-                    values[count++] = o;
-                    o = vm::Field::GetValueObject(field, that);
-                    values[count++] = o;
+                    AddEntry(entries, PlanEntry::kBoxed, offset, field);
+                    break;
             }
 
             if (klass->enumtype)
                 /* enums only have one non-static field */
                 break;
         }
+    }
+
+    static const Il2CppValueTypeEqualityPlan* GetEqualityPlan(Il2CppClass* klass)
+    {
+        const Il2CppValueTypeEqualityPlan* plan = os::Atomic::ReadPointer(&klass->valueTypeEqualityPlan);
+        if (plan != NULL)
+            return plan;
+
+        PlanEntries entries;
+        BuildEqualityPlan(klass, sizeof(Il2CppObject), entries);
+
+        Il2CppValueTypeEqualityPlan* newPlan = (Il2CppValueTypeEqualityPlan*)IL2CPP_MALLOC(sizeof(Il2CppValueTypeEqualityPlan) + entries.size() * sizeof(PlanEntry));
+        newPlan->entryCount = (uint32_t)entries.size();
+        newPlan->hasManagedFields = false;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            newPlan->entries[i] = entries[i];
+            if (entries[i].kind == PlanEntry::kReference || entries[i].kind == PlanEntry::kBoxed)
+                newPlan->hasManagedFields = true;
+        }
+
+        // Another thread may have built the same plan in the meantime. Keep the one published first.
+        plan = os::Atomic::CompareExchangePointer(&klass->valueTypeEqualityPlan, newPlan, (Il2CppValueTypeEqualityPlan*)NULL);
+        if (plan != NULL)
+        {
+            IL2CPP_FREE(newPlan);
+            return plan;
+        }
+
+        return newPlan;
+    }
+
+    static bool StringFieldsEqual(Il2CppString* s1, Il2CppString* s2)
+    {
+        if (s1 == s2)
+            return true;
+        if ((s1 == NULL) || (s2 == NULL))
+            return false;
+
+        uint32_t s1len = utils::StringUtils::GetLength(s1);
+        uint32_t s2len = utils::StringUtils::GetLength(s2);
+        if (s1len != s2len)
+            return false;
+
+        return memcmp(utils::StringUtils::GetChars(s1), utils::StringUtils::GetChars(s2), s1len * sizeof(Il2CppChar)) == 0;
+    }
+
+    static size_t HashRawBytes(size_t hash, const uint8_t* data, uint32_t size)
+    {
+        uint32_t i = 0;
+        for (; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t))
+        {
+            uint32_t word;
+            memcpy(&word, data + i, sizeof(uint32_t));
+            hash = il2cpp::utils::HashUtils::Combine(hash, word);
+        }
+
+        for (; i < size; ++i)
+            hash = il2cpp::utils::HashUtils::Combine(hash, data[i]);
+
+        return hash;
+    }
+
+    static void ReturnFieldValues(Il2CppArray** fields, Il2CppObject** values, int count)
+    {
+        WriteBarrier::GenericStore(fields, vm::Array::New(il2cpp_defaults.object_class, count));
+        for (int i = 0; i < count; ++i)
+            il2cpp_array_setref(*fields, i, values[i]);
+    }
+
+    bool ValueType::InternalEquals(Il2CppObject * thisPtr, Il2CppObject * that, Il2CppArray** fields)
+    {
+        Il2CppClass *klass;
+        Il2CppObject **values = NULL;
+        int count = 0;
+
+        IL2CPP_CHECK_ARG_NULL(that);
+
+        if (thisPtr->klass != that->klass)
+            return false;
+
+        klass = vm::Object::GetClass(thisPtr);
+
+        if (klass->enumtype && vm::Class::GetEnumBaseType(klass) && vm::Class::GetEnumBaseType(klass)->type == IL2CPP_TYPE_I4)
+            return (*(int32_t*)((uint8_t*)thisPtr + sizeof(Il2CppObject)) == *(int32_t*)((uint8_t*)that + sizeof(Il2CppObject)));
+
+        /*
+         * Do the comparison for fields that can be compared natively and return a
+         * result if possible. Otherwise, return the remaining fields in an array to the
+         * managed side. This way, we can avoid costly reflection operations in
+         * managed code.
+         */
+        *fields = NULL;
+        const Il2CppValueTypeEqualityPlan* plan = GetEqualityPlan(klass);
+        for (uint32_t i = 0; i < plan->entryCount; ++i)
+        {
+            const PlanEntry& entry = plan->entries[i];
+            const uint8_t* thisField = (const uint8_t*)thisPtr + entry.offset;
+            const uint8_t* thatField = (const uint8_t*)that + entry.offset;
+
+            switch (entry.kind)
+            {
+                case PlanEntry::kRawBytes:
+                    if (memcmp(thisField, thatField, entry.size) != 0)
+                        return false;
+                    break;
+                case PlanEntry::kSingle:
+                    if (*(const float*)thisField != *(const float*)thatField)
+                        return false;
+                    break;
+                case PlanEntry::kDouble:
+                    if (*(const double*)thisField != *(const double*)thatField)
+                        return false;
+                    break;
+                case PlanEntry::kString:
+                    if (!StringFieldsEqual(*(Il2CppString**)thisField, *(Il2CppString**)thatField))
+                        return false;
+                    break;
+                case PlanEntry::kReference:
+                {
+                    Il2CppObject* thisValue = *(Il2CppObject**)thisField;
+                    Il2CppObject* thatValue = *(Il2CppObject**)thatField;
+                    if (thisValue == thatValue)
+                        break;
+                    if (thisValue == NULL || thatValue == NULL)
+                        return false;
+                    if (!values)
+                        values = (Il2CppObject**)alloca(sizeof(Il2CppObject*) * plan->entryCount * 2);
+                    values[count++] = thisValue;
+                    values[count++] = thatValue;
+                    break;
+                }
+                case PlanEntry::kBoxed:
+                    if (!values)
+                        values = (Il2CppObject**)alloca(sizeof(Il2CppObject*) * plan->entryCount * 2);
+                    values[count++] = vm::Field::GetValueObject(entry.field, thisPtr);
+                    values[count++] = vm::Field::GetValueObject(entry.field, that);
+                    break;
+            }
+        }
 
         if (values)
         {
-            int i;
-            WriteBarrier::GenericStore(fields, vm::Array::New(il2cpp_defaults.object_class, count));
-            for (i = 0; i < count; ++i)
-                il2cpp_array_setref(*fields, i, values[i]);
+            ReturnFieldValues(fields, values, count);
             return false;
         }
         else
@@ -144,65 +356,74 @@ namespace System
     {
         Il2CppObject **values = NULL;
         int count = 0;
-        FieldInfo* field = NULL;
-        void* iter = NULL;
 
         Il2CppClass* klass = vm::Object::GetClass(obj);
-        int32_t result = (int32_t)il2cpp::utils::HashUtils::AlignedPointerHash(klass);
-
-        if (vm::Class::GetNumFields(klass) == 0)
-            return result;
+        size_t result = il2cpp::utils::HashUtils::AlignedPointerHash(klass);
 
         /*
-         * Compute the starting value of the hashcode for fields of primitive
-         * types, and return the remaining fields in an array to the managed side.
+         * Compute the starting value of the hashcode for fields that can be hashed
+         * natively, and return the remaining fields in an array to the managed side.
          * This way, we can avoid costly reflection operations in managed code.
          */
-        iter = NULL;
-        while ((field = vm::Class::GetFields(klass, &iter)))
+        const Il2CppValueTypeEqualityPlan* plan = GetEqualityPlan(klass);
+        for (uint32_t i = 0; i < plan->entryCount; ++i)
         {
-            if (field->type->attrs & FIELD_ATTRIBUTE_STATIC)
-                continue;
-            if (vm::Field::IsDeleted(field))
-                continue;
-            /* FIXME: Add more types */
-            switch (field->type->type)
+            const PlanEntry& entry = plan->entries[i];
+            const uint8_t* field = (const uint8_t*)obj + entry.offset;
+
+            switch (entry.kind)
             {
-                case IL2CPP_TYPE_I4:
-                    result ^= *(int32_t*)((uint8_t*)obj + field->offset);
+                case PlanEntry::kRawBytes:
+                    result = HashRawBytes(result, field, entry.size);
                     break;
-                case IL2CPP_TYPE_STRING:
+                case PlanEntry::kSingle:
+                {
+                    // Equals compares with ==, so 0.0 and -0.0 must hash the same.
+                    float value = *(const float*)field;
+                    if (value == 0.0f)
+                        value = 0.0f;
+                    result = HashRawBytes(result, (const uint8_t*)&value, sizeof(value));
+                    break;
+                }
+                case PlanEntry::kDouble:
                 {
-                    Il2CppString *s;
-                    s = *(Il2CppString**)((uint8_t*)obj + field->offset);
+                    double value = *(const double*)field;
+                    if (value == 0.0)
+                        value = 0.0;
+                    result = HashRawBytes(result, (const uint8_t*)&value, sizeof(value));
+                    break;
+                }
+                case PlanEntry::kString:
+                {
+                    Il2CppString* s = *(Il2CppString**)field;
                     if (s != NULL)
-                        result ^= vm::String::GetHash(s);
+                        result = il2cpp::utils::HashUtils::Combine(result, vm::String::GetHash(s));
                     break;
                 }
-                case IL2CPP_TYPE_PTR:
-                    result ^= il2cpp::utils::HashUtils::AlignedPointerHash(*(void**)((uint8_t*)obj + field->offset));
+                case PlanEntry::kReference:
+                {
+                    Il2CppObject* value = *(Il2CppObject**)field;
+                    if (value == NULL)
+                        break;
+                    if (!values)
+                        values = (Il2CppObject**)alloca(sizeof(Il2CppObject*) * plan->entryCount);
+                    values[count++] = value;
                     break;
-                default:
+                }
+                case PlanEntry::kBoxed:
                     if (!values)
-                        values = (Il2CppObject**)alloca(sizeof(Il2CppObject*) * vm::Class::GetNumFields(klass));
-                    Il2CppObject* o = vm::Field::GetValueObject(field, obj);
-                    values[count++] = o;
+                        values = (Il2CppObject**)alloca(sizeof(Il2CppObject*) * plan->entryCount);
+                    values[count++] = vm::Field::GetValueObject(entry.field, obj);
+                    break;
             }
         }
 
         if (values)
-        {
-            int i;
-            WriteBarrier::GenericStore(fields, vm::Array::New(il2cpp_defaults.object_class, count));
-            for (i = 0; i < count; ++i)
-                il2cpp_array_setref(*fields, i, values[i]);
-        }
+            ReturnFieldValues(fields, values, count);
         else
-        {
             *fields = NULL;
-        }
 
-        return result;
+        return (int32_t)result;
     }
 } /* namespace System */
 } /* namespace mscorlib */
@@ -89,6 +89,7 @@ DO_API(void, il2cpp_class_get_bitmap, (Il2CppClass * klass, size_t * bitmap));
 // stats
 DO_API(bool, il2cpp_stats_dump_to_file, (const char *path));
 DO_API(uint64_t, il2cpp_stats_get_value, (Il2CppStat stat));
+DO_API(void, il2cpp_stats_get_histogram, (Il2CppStatHistogram histogram, Il2CppStatHistogramData* data));
 
 // domain
 DO_API(Il2CppDomain*, il2cpp_domain_get, ());
@@ -121,6 +122,7 @@ DO_API(bool, il2cpp_field_is_literal, (FieldInfo * field));
 // gc
 DO_API(void, il2cpp_gc_collect, (int maxGenerations));
 DO_API(int32_t, il2cpp_gc_collect_a_little, ());
+DO_API(int32_t, il2cpp_gc_collect_a_little_ns, (int64_t budgetNs));
 DO_API(void, il2cpp_gc_start_incremental_collection , ());
 DO_API(void, il2cpp_gc_disable, ());
 DO_API(void, il2cpp_gc_enable, ());
@@ -129,6 +131,8 @@ DO_API(void, il2cpp_gc_set_mode, (Il2CppGCMode mode));
 DO_API(int64_t, il2cpp_gc_get_max_time_slice_ns, ());
 DO_API(void, il2cpp_gc_set_max_time_slice_ns, (int64_t maxTimeSlice));
 DO_API(bool, il2cpp_gc_is_incremental, ());
+DO_API(int32_t, il2cpp_gc_get_marker_thread_count, ());
+DO_API(void, il2cpp_gc_set_marker_thread_count, (int32_t count));
 DO_API(int64_t, il2cpp_gc_get_used_size, ());
 DO_API(int64_t, il2cpp_gc_get_heap_size, ());
 DO_API(void, il2cpp_gc_wbarrier_set_field, (Il2CppObject * obj, void **targetAddress, void *object));
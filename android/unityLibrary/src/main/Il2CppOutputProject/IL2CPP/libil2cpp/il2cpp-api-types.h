@@ -97,12 +97,34 @@ typedef enum
     IL2CPP_STAT_INFLATED_METHOD_COUNT,
     IL2CPP_STAT_INFLATED_TYPE_COUNT,
     //IL2CPP_STAT_DELEGATE_CREATIONS,
-    //IL2CPP_STAT_MINOR_GC_COUNT,
-    //IL2CPP_STAT_MAJOR_GC_COUNT,
-    //IL2CPP_STAT_MINOR_GC_TIME_USECS,
-    //IL2CPP_STAT_MAJOR_GC_TIME_USECS
+    IL2CPP_STAT_MINOR_GC_COUNT,
+    IL2CPP_STAT_MAJOR_GC_COUNT,
+    IL2CPP_STAT_MINOR_GC_TIME_USECS,
+    IL2CPP_STAT_MAJOR_GC_TIME_USECS
 } Il2CppStat;
 
+typedef enum
+{
+    IL2CPP_STAT_HISTOGRAM_GC_PAUSE_USECS,      // each stop-the-world pause
+    IL2CPP_STAT_HISTOGRAM_GC_MARK_USECS,       // stopped mark phase of each collection
+    IL2CPP_STAT_HISTOGRAM_GC_SWEEP_USECS,      // reclaim phase of each collection
+    IL2CPP_STAT_HISTOGRAM_GC_RECLAIMED_BYTES,  // bytes reclaimed immediately by each collection
+    IL2CPP_STAT_HISTOGRAM_GC_HEAP_SIZE_BEFORE, // GC heap size before each reclaim phase
+    IL2CPP_STAT_HISTOGRAM_GC_HEAP_SIZE_AFTER   // GC heap size after each reclaim phase
+} Il2CppStatHistogram;
+
+// Bucket 0 counts zero values, bucket i values in [2^(i-1), 2^i); the last bucket also takes
+// everything larger.
+#define IL2CPP_STAT_HISTOGRAM_BUCKET_COUNT 40
+
+typedef struct Il2CppStatHistogramData
+{
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[IL2CPP_STAT_HISTOGRAM_BUCKET_COUNT];
+} Il2CppStatHistogramData;
+
 typedef enum
 {
     IL2CPP_UNHANDLED_POLICY_LEGACY,
@@ -473,6 +473,31 @@ bool il2cpp_stats_dump_to_file(const char *path)
     fs << "Initialized class count: " << il2cpp_stats_get_value(IL2CPP_STAT_INITIALIZED_CLASS_COUNT) << "\n";
     fs << "Generic instance count: " << il2cpp_stats_get_value(IL2CPP_STAT_GENERIC_INSTANCE_COUNT) << "\n";
     fs << "Generic class count: " << il2cpp_stats_get_value(IL2CPP_STAT_GENERIC_CLASS_COUNT) << "\n";
+    fs << "Minor GC count: " << il2cpp_stats_get_value(IL2CPP_STAT_MINOR_GC_COUNT) << "\n";
+    fs << "Major GC count: " << il2cpp_stats_get_value(IL2CPP_STAT_MAJOR_GC_COUNT) << "\n";
+    fs << "Minor GC time (usecs): " << il2cpp_stats_get_value(IL2CPP_STAT_MINOR_GC_TIME_USECS) << "\n";
+    fs << "Major GC time (usecs): " << il2cpp_stats_get_value(IL2CPP_STAT_MAJOR_GC_TIME_USECS) << "\n";
+
+    static const char* const histogramNames[] =
+    {
+        "GC pause (usecs)",
+        "GC mark (usecs)",
+        "GC sweep (usecs)",
+        "GC reclaimed bytes",
+        "GC heap size before",
+        "GC heap size after"
+    };
+    for (int i = 0; i <= IL2CPP_STAT_HISTOGRAM_GC_HEAP_SIZE_AFTER; i++)
+    {
+        Il2CppStatHistogramData data;
+        il2cpp_stats_get_histogram((Il2CppStatHistogram)i, &data);
+        fs << histogramNames[i] << ": count " << data.count << ", sum " << data.sum << ", max " << data.max << "\n";
+        for (int bucket = 0; bucket < IL2CPP_STAT_HISTOGRAM_BUCKET_COUNT; bucket++)
+        {
+            if (data.buckets[bucket] != 0)
+                fs << "    < " << (1ULL << bucket) << ": " << data.buckets[bucket] << "\n";
+        }
+    }
 
     fs.close();
 
@@ -518,24 +543,56 @@ uint64_t il2cpp_stats_get_value(Il2CppStat stat)
             return il2cpp_runtime_stats.inflated_type_count;
 
             /*case IL2CPP_STAT_DELEGATE_CREATIONS:
-                return il2cpp_runtime_stats.delegate_creations;
+                return il2cpp_runtime_stats.delegate_creations;*/
 
-            case IL2CPP_STAT_MINOR_GC_COUNT:
-                return il2cpp_runtime_stats.minor_gc_count;
+        case IL2CPP_STAT_MINOR_GC_COUNT:
+            return il2cpp_runtime_stats.minor_gc_count;
 
-            case IL2CPP_STAT_MAJOR_GC_COUNT:
-                return il2cpp_runtime_stats.major_gc_count;
+        case IL2CPP_STAT_MAJOR_GC_COUNT:
+            return il2cpp_runtime_stats.major_gc_count;
 
-            case IL2CPP_STAT_MINOR_GC_TIME_USECS:
-                return il2cpp_runtime_stats.minor_gc_time_usecs;
+        case IL2CPP_STAT_MINOR_GC_TIME_USECS:
+            return il2cpp_runtime_stats.minor_gc_time_usecs;
 
-            case IL2CPP_STAT_MAJOR_GC_TIME_USECS:
-                return il2cpp_runtime_stats.major_gc_time_usecs;*/
+        case IL2CPP_STAT_MAJOR_GC_TIME_USECS:
+            return il2cpp_runtime_stats.major_gc_time_usecs;
     }
 
     return 0;
 }
 
+void il2cpp_stats_get_histogram(Il2CppStatHistogram histogram, Il2CppStatHistogramData* data)
+{
+    switch (histogram)
+    {
+        case IL2CPP_STAT_HISTOGRAM_GC_PAUSE_USECS:
+            il2cpp_runtime_stats.gc_pause_usecs.CopyTo(data);
+            return;
+
+        case IL2CPP_STAT_HISTOGRAM_GC_MARK_USECS:
+            il2cpp_runtime_stats.gc_mark_usecs.CopyTo(data);
+            return;
+
+        case IL2CPP_STAT_HISTOGRAM_GC_SWEEP_USECS:
+            il2cpp_runtime_stats.gc_sweep_usecs.CopyTo(data);
+            return;
+
+        case IL2CPP_STAT_HISTOGRAM_GC_RECLAIMED_BYTES:
+            il2cpp_runtime_stats.gc_reclaimed_bytes.CopyTo(data);
+            return;
+
+        case IL2CPP_STAT_HISTOGRAM_GC_HEAP_SIZE_BEFORE:
+            il2cpp_runtime_stats.gc_heap_size_before.CopyTo(data);
+            return;
+
+        case IL2CPP_STAT_HISTOGRAM_GC_HEAP_SIZE_AFTER:
+            il2cpp_runtime_stats.gc_heap_size_after.CopyTo(data);
+            return;
+    }
+
+    memset(data, 0, sizeof(*data));
+}
+
 // domain
 Il2CppDomain* il2cpp_domain_get()
 {
@@ -699,6 +756,11 @@ int32_t il2cpp_gc_collect_a_little()
     return GarbageCollector::CollectALittle();
 }
 
+int32_t il2cpp_gc_collect_a_little_ns(int64_t budgetNs)
+{
+    return GarbageCollector::CollectALittle(budgetNs);
+}
+
 void il2cpp_gc_start_incremental_collection()
 {
     GarbageCollector::StartIncrementalCollection();
@@ -729,6 +791,16 @@ bool il2cpp_gc_is_incremental()
     return GarbageCollector::IsIncremental();
 }
 
+int32_t il2cpp_gc_get_marker_thread_count()
+{
+    return GarbageCollector::GetMarkerThreadCount();
+}
+
+void il2cpp_gc_set_marker_thread_count(int32_t count)
+{
+    GarbageCollector::SetMarkerThreadCount(count);
+}
+
 int64_t il2cpp_gc_get_max_time_slice_ns()
 {
     return GarbageCollector::GetMaxTimeSliceNs();
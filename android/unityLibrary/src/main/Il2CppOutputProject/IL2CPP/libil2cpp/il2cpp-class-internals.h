@@ -23,6 +23,7 @@ typedef struct Il2CppAppDomainSetup Il2CppAppDomainSetup;
 typedef struct Il2CppDelegate Il2CppDelegate;
 typedef struct Il2CppAppContext Il2CppAppContext;
 typedef struct Il2CppNameToTypeHandleHashTable Il2CppNameToTypeHandleHashTable;
+typedef struct Il2CppCodeGenTokenIndex Il2CppCodeGenTokenIndex;
 typedef struct Il2CppCodeGenModule Il2CppCodeGenModule;
 typedef struct Il2CppMetadataRegistration Il2CppMetadataRegistration;
 typedef struct Il2CppCodeRegistration Il2CppCodeRegistration;
@@ -375,6 +376,14 @@ typedef struct Il2CppRuntimeInterfaceOffsetPair
 #pragma clang diagnostic ignored "-Winvalid-offsetof"
 #endif
 
+// Open addressing table over interfaceOffsets, keyed by interfaceType. The number of
+// entries is mask + 1 (a power of two) and at most half of them are used.
+typedef struct Il2CppRuntimeInterfaceOffsetTable
+{
+    uint32_t mask;
+    Il2CppRuntimeInterfaceOffsetPair entries[IL2CPP_ZERO_LEN_ARRAY];
+} Il2CppRuntimeInterfaceOffsetTable;
+
 typedef struct Il2CppClass
 {
     // The following fields are always valid for a Il2CppClass structure
@@ -462,6 +471,11 @@ typedef struct Il2CppClass
     uint8_t is_import_or_windows_runtime : 1;
     uint8_t is_vtable_initialized : 1;
     uint8_t is_byref_like : 1;
+
+    // Runtime-only fields, kept after the fields above so their offsets do not move
+    const Il2CppRuntimeInterfaceOffsetTable* interfaceOffsetTable; // Initialized in Init, NULL for classes with few interfaces
+    struct Il2CppValueTypeEqualityPlan* valueTypeEqualityPlan; // Lazily initialized by ValueType::InternalEquals and InternalGetHashCode
+
     VirtualInvokeData vtable[IL2CPP_ZERO_LEN_ARRAY];
 } Il2CppClass;
 
@@ -525,6 +539,11 @@ typedef struct Il2CppImage
 #endif
     Il2CppNameToTypeHandleHashTable * nameToClassHashTable;
 
+#ifdef __cplusplus
+    mutable
+#endif
+    Il2CppCodeGenTokenIndex * codeGenTokenIndex;
+
     const Il2CppCodeGenModule* codeGenModule;
 
     uint32_t token;
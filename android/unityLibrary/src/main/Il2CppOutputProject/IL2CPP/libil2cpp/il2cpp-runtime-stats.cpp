@@ -1,3 +1,30 @@
 #include "il2cpp-runtime-stats.h"
 
-Il2CppRuntimeStats il2cpp_runtime_stats = {{ 0 }};
+#include "Baselib.h"
+#include "Cpp/Algorithm.h"
+
+Il2CppRuntimeStats il2cpp_runtime_stats;
+
+void Il2CppRuntimeStatsHistogram::Record(uint64_t value)
+{
+    int bucket = value == 0 ? 0 : baselib::Algorithm::HighestBitNonZero(value) + 1;
+    if (bucket >= IL2CPP_STAT_HISTOGRAM_BUCKET_COUNT)
+        bucket = IL2CPP_STAT_HISTOGRAM_BUCKET_COUNT - 1;
+
+    buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t currentMax = max.load(std::memory_order_relaxed);
+    while (value > currentMax && !max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed))
+    {
+    }
+    count.fetch_add(1, std::memory_order_release);
+}
+
+void Il2CppRuntimeStatsHistogram::CopyTo(Il2CppStatHistogramData* data) const
+{
+    data->count = count.load(std::memory_order_acquire);
+    data->sum = sum.load(std::memory_order_relaxed);
+    data->max = max.load(std::memory_order_relaxed);
+    for (int i = 0; i < IL2CPP_STAT_HISTOGRAM_BUCKET_COUNT; i++)
+        data->buckets[i] = buckets[i].load(std::memory_order_relaxed);
+}
@@ -1,11 +1,65 @@
 #pragma once
 
 #include <atomic>
+#include <stddef.h>
 #include <stdint.h>
+#include "il2cpp-api-types.h"
+
+// Counter bumped from every allocating thread. Increments land in one of several cache line
+// sized shards picked from the caller's stack address, so threads rarely share a line;
+// reading the value sums the shards and is only done when stats are queried.
+struct Il2CppShardedCounter
+{
+    enum { kShardCount = 16 };
+
+    struct Shard
+    {
+        alignas(64) std::atomic<uint64_t> value;
+    };
+
+    Shard shards[kShardCount];
+
+    Il2CppShardedCounter& operator++()
+    {
+        shards[CurrentShard()].value.fetch_add(1, std::memory_order_relaxed);
+        return *this;
+    }
+
+    operator uint64_t() const
+    {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < kShardCount; i++)
+            sum += shards[i].value.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    static size_t CurrentShard()
+    {
+        // Thread stacks are spaced by large powers of two, so hash the 64KB region of the stack
+        // rather than taking its low bits.
+        char marker;
+        uint64_t region = (uint64_t)(uintptr_t)&marker >> 16;
+        return (size_t)((region * 0x9E3779B97F4A7C15ULL) >> 32) % kShardCount;
+    }
+};
+
+// Power of two histogram that the GC records into while stats may be read from any thread.
+// Each field is updated on its own, so a snapshot taken mid-record can be off by one sample.
+struct Il2CppRuntimeStatsHistogram
+{
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+    std::atomic<uint64_t> buckets[IL2CPP_STAT_HISTOGRAM_BUCKET_COUNT];
+
+    void Record(uint64_t value);
+    void CopyTo(Il2CppStatHistogramData* data) const;
+};
 
 struct Il2CppRuntimeStats
 {
-    std::atomic<uint64_t> new_object_count;
+    Il2CppShardedCounter new_object_count;
     std::atomic<uint64_t> initialized_class_count;
     // uint64_t generic_vtable_count;
     // uint64_t used_class_count;
@@ -17,10 +71,16 @@ struct Il2CppRuntimeStats
     std::atomic<uint64_t> inflated_method_count;
     std::atomic<uint64_t> inflated_type_count;
     // uint64_t delegate_creations;
-    // uint64_t minor_gc_count;
-    // uint64_t major_gc_count;
-    // uint64_t minor_gc_time_usecs;
-    // uint64_t major_gc_time_usecs;
+    std::atomic<uint64_t> minor_gc_count;
+    std::atomic<uint64_t> major_gc_count;
+    std::atomic<uint64_t> minor_gc_time_usecs;
+    std::atomic<uint64_t> major_gc_time_usecs;
+    Il2CppRuntimeStatsHistogram gc_pause_usecs;
+    Il2CppRuntimeStatsHistogram gc_mark_usecs;
+    Il2CppRuntimeStatsHistogram gc_sweep_usecs;
+    Il2CppRuntimeStatsHistogram gc_reclaimed_bytes;
+    Il2CppRuntimeStatsHistogram gc_heap_size_before;
+    Il2CppRuntimeStatsHistogram gc_heap_size_after;
     bool enabled;
 };
 
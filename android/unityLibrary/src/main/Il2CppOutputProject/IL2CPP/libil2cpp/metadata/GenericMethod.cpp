@@ -16,6 +16,7 @@
 #include "vm/Method.h"
 #include "vm/Runtime.h"
 #include "vm/Type.h"
+#include "utils/HashUtils.h"
 #include "utils/Il2CppHashMap.h"
 #include "utils/InitOnce.h"
 #include "il2cpp-class-internals.h"
@@ -29,6 +30,7 @@ using il2cpp::os::FastAutoLock;
 using il2cpp::vm::Class;
 using il2cpp::vm::GenericClass;
 using il2cpp::vm::MetadataCalloc;
+using il2cpp::vm::MetadataMalloc;
 using il2cpp::vm::MetadataCache;
 using il2cpp::vm::Method;
 using il2cpp::vm::Runtime;
@@ -69,6 +71,31 @@ namespace metadata
     static Il2CppGenericMethodMap s_GenericMethodMap;
     static Il2CppGenericMethodMap s_PendingGenericMethodMap;
 
+    // Generic virtual method resolutions are cached per (vtable slot method, generic virtual method) pair.
+    // Entries are never freed, so a hit in the direct mapped table needs no lock and no Il2CppGenericMethod hash.
+    struct GenericVirtualMethodCacheEntry
+    {
+        const MethodInfo* vtableSlotMethod;
+        const MethodInfo* genericVirtualMethod;
+        const MethodInfo* method;
+    };
+
+    typedef std::pair<const MethodInfo*, const MethodInfo*> GenericVirtualMethodKey;
+
+    struct GenericVirtualMethodKeyHash
+    {
+        size_t operator()(const GenericVirtualMethodKey& key) const
+        {
+            return il2cpp::utils::HashUtils::Combine(il2cpp::utils::HashUtils::AlignedPointerHash(key.first), il2cpp::utils::HashUtils::AlignedPointerHash(key.second));
+        }
+    };
+
+    typedef Il2CppReaderWriterLockedHashMap<GenericVirtualMethodKey, GenericVirtualMethodCacheEntry*, GenericVirtualMethodKeyHash> GenericVirtualMethodEntryMap;
+    static GenericVirtualMethodEntryMap s_GenericVirtualMethodEntries;
+
+    static const size_t kGenericVirtualMethodCacheSize = 4096;
+    static GenericVirtualMethodCacheEntry* s_GenericVirtualMethodCache[kGenericVirtualMethodCacheSize];
+
     static bool HasFullGenericSharedParametersOrReturn(const MethodInfo* methodDefinition)
     {
         if (Type::HasVariableRuntimeSizeWhenFullyShared(methodDefinition->return_type))
@@ -100,10 +127,8 @@ namespace metadata
         return method == &ambiguousMethodInfo;
     }
 
-    const MethodInfo* GenericMethod::GetGenericVirtualMethod(const MethodInfo* vtableSlotMethod, const MethodInfo* genericVirtualMethod)
+    static const MethodInfo* GetGenericVirtualMethodSlow(const MethodInfo* vtableSlotMethod, const MethodInfo* genericVirtualMethod)
     {
-        IL2CPP_NOT_IMPLEMENTED_NO_ASSERT(GetGenericVirtualMethod, "We should only do the following slow method lookup once and then cache on type itself.");
-
         const Il2CppGenericInst* classInst = NULL;
         if (vtableSlotMethod->is_inflated)
         {
@@ -114,6 +139,36 @@ namespace metadata
         return metadata::GenericMethod::GetMethod(vtableSlotMethod, classInst, genericVirtualMethod->genericMethod->context.method_inst);
     }
 
+    const MethodInfo* GenericMethod::GetGenericVirtualMethod(const MethodInfo* vtableSlotMethod, const MethodInfo* genericVirtualMethod)
+    {
+        GenericVirtualMethodKey key(vtableSlotMethod, genericVirtualMethod);
+        GenericVirtualMethodCacheEntry** cacheSlot = &s_GenericVirtualMethodCache[GenericVirtualMethodKeyHash()(key) & (kGenericVirtualMethodCacheSize - 1)];
+
+        GenericVirtualMethodCacheEntry* entry = il2cpp::os::Atomic::ReadPointer(cacheSlot);
+        if (entry != NULL && entry->vtableSlotMethod == vtableSlotMethod && entry->genericVirtualMethod == genericVirtualMethod)
+            return entry->method;
+
+        if (!s_GenericVirtualMethodEntries.TryGet(key, &entry))
+        {
+            const MethodInfo* method = GetGenericVirtualMethodSlow(vtableSlotMethod, genericVirtualMethod);
+
+            FastAutoLock lock(&il2cpp::vm::g_MetadataLock);
+
+            // Another thread may have added the entry while we were resolving the method
+            if (!s_GenericVirtualMethodEntries.TryGet(key, &entry))
+            {
+                entry = (GenericVirtualMethodCacheEntry*)MetadataMalloc(sizeof(GenericVirtualMethodCacheEntry));
+                entry->vtableSlotMethod = vtableSlotMethod;
+                entry->genericVirtualMethod = genericVirtualMethod;
+                entry->method = method;
+                s_GenericVirtualMethodEntries.Add(key, entry);
+            }
+        }
+
+        il2cpp::os::Atomic::PublishPointer(cacheSlot, entry);
+        return entry->method;
+    }
+
     const MethodInfo* GenericMethod::GetMethod(const MethodInfo* methodDefinition, const Il2CppGenericInst* classInst, const Il2CppGenericInst* methodInst)
     {
         Il2CppGenericMethod gmethod = { 0 };
@@ -356,6 +411,8 @@ namespace metadata
     void GenericMethod::ClearStatics()
     {
         s_GenericMethodMap.Clear();
+        s_GenericVirtualMethodEntries.Clear();
+        memset(s_GenericVirtualMethodCache, 0, sizeof(s_GenericVirtualMethodCache));
     }
 } /* namespace vm */
 } /* namespace il2cpp */
@@ -0,0 +1,135 @@
+#include "il2cpp-config.h"
+
+#include "mono/ThreadPool/threadpool-ms-io-epoll.h"
+
+#if IL2CPP_USE_EPOLL_FOR_IO_SELECTOR
+
+#include "gc/GarbageCollector.h"
+#include "mono/ThreadPool/threadpool-ms-io-poll.h"
+#include "vm/Thread.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+#ifndef EPOLLONESHOT
+/* it was only defined on android in May 2013 */
+#define EPOLLONESHOT 0x40000000
+#endif
+
+#define EPOLL_NEVENTS 128
+
+static int epoll_fd = -1;
+static struct epoll_event epoll_events[EPOLL_NEVENTS];
+
+bool epoll_init(int wakeup_pipe_fd)
+{
+    struct epoll_event event;
+
+    IL2CPP_ASSERT(wakeup_pipe_fd >= 0);
+
+#ifdef EPOLL_CLOEXEC
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+#else
+    epoll_fd = epoll_create(256);
+    if (epoll_fd != -1)
+        fcntl(epoll_fd, F_SETFD, FD_CLOEXEC);
+#endif
+
+    if (epoll_fd == -1)
+        return false;
+
+    /* The wakeup pipe stays armed for the lifetime of the selector thread */
+    event.events = EPOLLIN;
+    event.data.fd = wakeup_pipe_fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_pipe_fd, &event) == -1)
+    {
+        close(epoll_fd);
+        epoll_fd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+void epoll_register_fd(int fd, int events, bool is_new)
+{
+    struct epoll_event event;
+
+    IL2CPP_ASSERT(fd >= 0);
+    IL2CPP_ASSERT((events & ~(EVENT_IN | EVENT_OUT)) == 0);
+
+    /* Every fd is one-shot: once it is reported, wait_callback re-arms it
+     * with the operations of the jobs that are still pending, exactly as
+     * the poll backend rebuilds its request for that fd. */
+    event.data.fd = fd;
+    event.events = EPOLLONESHOT;
+    if (events & EVENT_IN)
+        event.events |= EPOLLIN;
+    if (events & EVENT_OUT)
+        event.events |= EPOLLOUT;
+
+    if (epoll_ctl(epoll_fd, is_new ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event) == 0)
+        return;
+
+    /* The kernel drops closed descriptors from the interest list on its own,
+     * so the fd may be missing on modification, or still present when a
+     * previous registration was dropped on our side only. */
+    if (errno == ENOENT && !is_new)
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    else if (errno == EEXIST && is_new)
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void epoll_remove_fd(int fd)
+{
+    IL2CPP_ASSERT(fd >= 0);
+
+    /* ENOENT and EBADF mean the fd was already closed, which also removes it */
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+int epoll_event_wait(void (*callback)(int fd, int events, void* user_data), void* user_data)
+{
+    int i, ready;
+
+    il2cpp::gc::GarbageCollector::SetSkipThread(true);
+
+    ready = epoll_wait(epoll_fd, epoll_events, EPOLL_NEVENTS, -1);
+
+    il2cpp::gc::GarbageCollector::SetSkipThread(false);
+
+    if (ready == -1)
+    {
+        if (errno == EINTR)
+        {
+            il2cpp::vm::Thread::CheckCurrentThreadForInterruptAndThrowIfNecessary();
+            ready = 0;
+        }
+        else
+        {
+            IL2CPP_ASSERT(0 && "epoll_event_wait: epoll_wait () failed");
+            return -1;
+        }
+    }
+
+    for (i = 0; i < ready; ++i)
+    {
+        int fd, events = 0;
+
+        fd = epoll_events[i].data.fd;
+        if (epoll_events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+            events |= EVENT_IN;
+        if (epoll_events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+            events |= EVENT_OUT;
+        if (epoll_events[i].events & (EPOLLERR | EPOLLHUP))
+            events |= EVENT_ERR;
+
+        callback(fd, events, user_data);
+    }
+
+    return 0;
+}
+
+#endif // IL2CPP_USE_EPOLL_FOR_IO_SELECTOR
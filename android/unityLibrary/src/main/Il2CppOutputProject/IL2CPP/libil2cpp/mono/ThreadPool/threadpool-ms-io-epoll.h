@@ -0,0 +1,19 @@
+#pragma once
+
+#include "il2cpp-config.h"
+
+#ifndef IL2CPP_USE_EPOLL_FOR_IO_SELECTOR
+#define IL2CPP_USE_EPOLL_FOR_IO_SELECTOR (IL2CPP_TARGET_LINUX || IL2CPP_TARGET_ANDROID)
+#endif
+
+#if IL2CPP_USE_EPOLL_FOR_IO_SELECTOR
+
+bool epoll_init(int wakeup_pipe_fd);
+
+void epoll_register_fd(int fd, int events, bool is_new);
+
+int epoll_event_wait(void(*callback)(int fd, int events, void* user_data), void* user_data);
+
+void epoll_remove_fd(int fd);
+
+#endif
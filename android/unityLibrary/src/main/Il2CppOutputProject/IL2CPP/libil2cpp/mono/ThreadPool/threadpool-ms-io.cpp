@@ -37,8 +37,10 @@
 #include "mono/ThreadPool/threadpool-ms.h"
 #include "mono/ThreadPool/threadpool-ms-io.h"
 #include "mono/ThreadPool/threadpool-ms-io-poll.h"
+#include "mono/ThreadPool/threadpool-ms-io-epoll.h"
 #include "il2cpp-object-internals.h"
 #include "os/ConditionVariable.h"
+#include "os/Environment.h"
 #include "os/Mutex.h"
 #include "os/Socket.h"
 #include "utils/CallOnce.h"
@@ -119,6 +121,9 @@ static bool io_selector_running = false;
 static ThreadPoolIO* threadpool_io;
 
 static ThreadPoolIOBackend backend_poll = { poll_init, poll_register_fd, poll_remove_fd, poll_event_wait };
+#if IL2CPP_USE_EPOLL_FOR_IO_SELECTOR
+static ThreadPoolIOBackend backend_epoll = { epoll_init, epoll_register_fd, epoll_remove_fd, epoll_event_wait };
+#endif
 
 static Il2CppIOSelectorJob* get_job_for_event (ManagedList *list, int32_t event)
 {
@@ -599,22 +604,29 @@ static void threadpool_ms_io_initialize(void* args)
 	threadpool_io->updates_size = 0;
 
 	threadpool_io->backend = backend_poll;
-//	if (g_getenv ("MONO_ENABLE_AIO") != NULL) {
-//#if defined(HAVE_EPOLL)
-//		threadpool_io->backend = backend_epoll;
-//#elif defined(HAVE_KQUEUE)
-//		threadpool_io->backend = backend_kqueue;
-//#endif
-//	}
+#if IL2CPP_USE_EPOLL_FOR_IO_SELECTOR
+	/* epoll scales with the number of ready sockets rather than registered ones;
+	 * setting IL2CPP_DISABLE_AIO selects the poll backend instead */
+	if (il2cpp::os::Environment::GetEnvironmentVariable ("IL2CPP_DISABLE_AIO").empty ())
+		threadpool_io->backend = backend_epoll;
+#endif
 
 	wakeup_pipes_init ();
 
 #if IL2CPP_USE_PIPES_FOR_WAKEUP || IL2CPP_USE_EVENTFD_FOR_WAKEUP
-	if (!threadpool_io->backend.init ((int)threadpool_io->wakeup_pipes [0]))
+	int wakeup_fd = (int)threadpool_io->wakeup_pipes [0];
 #else
-	if (!threadpool_io->backend.init ((int)threadpool_io->wakeup_pipes [0]->GetDescriptor()))
+	int wakeup_fd = (int)threadpool_io->wakeup_pipes [0]->GetDescriptor();
 #endif
-		IL2CPP_ASSERT(0 && "initialize: backend->init () failed");
+
+	if (!threadpool_io->backend.init (wakeup_fd)) {
+#if IL2CPP_USE_EPOLL_FOR_IO_SELECTOR
+		/* e.g. a seccomp filter refusing epoll_create; poll always works */
+		threadpool_io->backend = backend_poll;
+		if (!threadpool_io->backend.init (wakeup_fd))
+#endif
+			IL2CPP_ASSERT(0 && "initialize: backend->init () failed");
+	}
 
 	if (!il2cpp::vm::Thread::CreateInternal(selector_thread, NULL, true, SMALL_STACK))
 		IL2CPP_ASSERT(0 && "initialize: vm::Thread::CreateInternal () failed ");
@@ -6,7 +6,139 @@
 
 #if IL2CPP_SUPPORT_THREADS
 
-#include <algorithm>
+#if IL2CPP_THREADS_PTHREAD
+
+#include "os/Posix/EventImpl.h"
+#include "os/Time.h"
+
+namespace il2cpp
+{
+namespace os
+{
+    // Blocking multi-object wait on POSIX. A single auto-reset waiter event is registered as a
+    // listener on every handle. Signaling any of the handles also signals the waiter, so the waiting
+    // thread sleeps until one of its handles changes state instead of polling them at an interval.
+    class MultiObjectWaiter : public il2cpp::utils::NonCopyable
+    {
+    public:
+        MultiObjectWaiter(const std::vector<Handle*>& handles)
+            : m_Handles(handles)
+            , m_Listeners(handles.size())
+            , m_Waiter(false, false)
+        {
+            for (size_t i = 0; i < m_Handles.size(); ++i)
+            {
+                m_Listeners[i].waiter = &m_Waiter;
+                GetWaitObject(i)->AddListener(&m_Listeners[i]);
+            }
+        }
+
+        ~MultiObjectWaiter()
+        {
+            for (size_t i = 0; i < m_Handles.size(); ++i)
+            {
+                if (m_Listeners[i].waiter != NULL)
+                    GetWaitObject(i)->RemoveListener(&m_Listeners[i]);
+            }
+        }
+
+        bool IsListening(size_t index) const
+        {
+            return m_Listeners[index].waiter != NULL;
+        }
+
+        void StopListening(size_t index)
+        {
+            GetWaitObject(index)->RemoveListener(&m_Listeners[index]);
+            m_Listeners[index].waiter = NULL;
+        }
+
+        // Blocks until any of the handles has been signaled since the previous call (or since the
+        // listeners were registered) or the timeout expires. Interruptible by APCs.
+        WaitStatus WaitForSignal(uint32_t ms)
+        {
+            return m_Waiter.Wait(ms, true);
+        }
+
+    private:
+        posix::PosixWaitObject* GetWaitObject(size_t index) const
+        {
+            return static_cast<posix::PosixWaitObject*>(m_Handles[index]->GetOSHandle());
+        }
+
+        const std::vector<Handle*>& m_Handles;
+        std::vector<posix::PosixWaitObjectListener> m_Listeners;
+        EventImpl m_Waiter;
+    };
+
+    static uint32_t GetRemainingWaitTime(int32_t ms, int64_t waitStartTime)
+    {
+        if (ms == -1)
+            return posix::kNoTimeout;
+
+        const int64_t timeWaitedMs = (Time::GetTicks100NanosecondsMonotonic() - waitStartTime) / 10000;
+        if (timeWaitedMs >= ms)
+            return 0;
+
+        return static_cast<uint32_t>(ms - timeWaitedMs);
+    }
+
+    int32_t Handle::WaitAny(const std::vector<Handle*>& handles, int32_t ms)
+    {
+        // Register before the first poll so that a signal arriving in between is not lost.
+        MultiObjectWaiter waiter(handles);
+        const int64_t waitStartTime = Time::GetTicks100NanosecondsMonotonic();
+
+        while (true)
+        {
+            int32_t numberOfOsHandles = (int32_t)handles.size();
+            for (int32_t i = 0; i < numberOfOsHandles; ++i)
+            {
+                if (handles[i]->Wait(0U))
+                    return i;
+            }
+
+            uint32_t remainingWaitTime = GetRemainingWaitTime(ms, waitStartTime);
+            if (remainingWaitTime == 0 || waiter.WaitForSignal(remainingWaitTime) == kWaitStatusFailure)
+                break;
+        }
+
+        return 258; // WAIT_TIMEOUT value
+    }
+
+    bool Handle::WaitAll(std::vector<Handle*>& handles, int32_t ms)
+    {
+        MultiObjectWaiter waiter(handles);
+        const int64_t waitStartTime = Time::GetTicks100NanosecondsMonotonic();
+
+        size_t numberOfUnsignaledHandles = handles.size();
+        while (true)
+        {
+            for (size_t i = 0; i < handles.size(); ++i)
+            {
+                // Handles that were acquired already no longer need to wake us up.
+                if (waiter.IsListening(i) && handles[i]->Wait(0U))
+                {
+                    waiter.StopListening(i);
+                    --numberOfUnsignaledHandles;
+                }
+            }
+
+            if (numberOfUnsignaledHandles == 0)
+                return true; // All handles have been signaled
+
+            uint32_t remainingWaitTime = GetRemainingWaitTime(ms, waitStartTime);
+            if (remainingWaitTime == 0 || waiter.WaitForSignal(remainingWaitTime) == kWaitStatusFailure)
+                break;
+        }
+
+        return false; // Timed out waiting for all handles to be signaled
+    }
+} // namespace os
+} // naemspace il2cpp
+
+#else
+
 #include "os/Thread.h"
 
 namespace il2cpp
@@ -37,19 +169,18 @@ namespace os
         int timeWaitedMs = 0;
         while (ms == -1 || timeWaitedMs <= ms)
         {
-            size_t numberOfOsHandles = handles.size();
-            std::vector<Handle*> signaledHandles;
-            for (size_t i = 0; i < numberOfOsHandles; ++i)
+            // Compact the handles that are still unsignaled to the front in a single pass.
+            size_t numberOfUnsignaledHandles = 0;
+            for (size_t i = 0; i < handles.size(); ++i)
             {
-                if (handles[i]->Wait(0U))
-                    signaledHandles.push_back(handles[i]);
+                if (!handles[i]->Wait(0U))
+                    handles[numberOfUnsignaledHandles++] = handles[i];
             }
 
-            if (signaledHandles.size() == numberOfOsHandles)
+            if (numberOfUnsignaledHandles == 0)
                 return true; // All handles have been signaled
 
-            for (size_t i = 0; i < signaledHandles.size(); ++i)
-                handles.erase(std::remove(handles.begin(), handles.end(), signaledHandles[i]), handles.end());
+            handles.resize(numberOfUnsignaledHandles);
 
             os::Thread::Sleep(m_waitIntervalMs, true);
             timeWaitedMs += m_waitIntervalMs;
@@ -60,6 +191,8 @@ namespace os
 } // namespace os
 } // naemspace il2cpp
 
+#endif // IL2CPP_THREADS_PTHREAD
+
 #else
 
 namespace il2cpp
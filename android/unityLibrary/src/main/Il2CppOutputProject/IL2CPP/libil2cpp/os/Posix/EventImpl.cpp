@@ -25,6 +25,8 @@ namespace os
         if (HaveWaitingThreads())
             pthread_cond_broadcast(&m_Condition);
 
+        NotifyListeners();
+
         return kErrorCodeSuccess;
     }
 
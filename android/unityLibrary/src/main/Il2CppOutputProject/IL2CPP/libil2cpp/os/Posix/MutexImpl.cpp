@@ -68,6 +68,8 @@ namespace os
         // comes around later and waits can claim the mutex.
         if (HaveWaitingThreads())
             pthread_cond_signal(&m_Condition);
+
+        NotifyListeners();
     }
 }
 }
@@ -36,6 +36,7 @@ namespace posix
         : m_Type(type)
         , m_Count(0)
         , m_WaitingThreadCount(0)
+        , m_Listeners(NULL)
     {
         pthread_mutex_init(&m_Mutex, NULL);
 #if !IL2CPP_USE_POSIX_COND_TIMEDWAIT_REL
@@ -242,8 +243,49 @@ namespace posix
 
     void* PosixWaitObject::GetOSHandle()
     {
-        IL2CPP_ASSERT(0 && "This function is not implemented and should not be called");
-        return NULL;
+        return this;
+    }
+
+    void PosixWaitObject::AddListener(PosixWaitObjectListener* listener)
+    {
+        posix::PosixAutoLock lock(&m_Mutex);
+
+        listener->previous = NULL;
+        listener->next = m_Listeners;
+        if (m_Listeners != NULL)
+            m_Listeners->previous = listener;
+        m_Listeners = listener;
+    }
+
+    void PosixWaitObject::RemoveListener(PosixWaitObjectListener* listener)
+    {
+        posix::PosixAutoLock lock(&m_Mutex);
+
+        if (listener->previous != NULL)
+            listener->previous->next = listener->next;
+        else
+            m_Listeners = listener->next;
+
+        if (listener->next != NULL)
+            listener->next->previous = listener->previous;
+
+        listener->next = NULL;
+        listener->previous = NULL;
+    }
+
+    void PosixWaitObject::NotifyListenersSlow()
+    {
+        // Lock order is always signaled object first, then waiter. A thread blocked on its waiter
+        // object never holds the mutex of any of the objects it listens on.
+        for (PosixWaitObjectListener* listener = m_Listeners; listener != NULL; listener = listener->next)
+        {
+            PosixWaitObject* waiter = listener->waiter;
+            posix::PosixAutoLock lock(&waiter->m_Mutex);
+
+            waiter->m_Count = 1;
+            if (waiter->HaveWaitingThreads())
+                pthread_cond_broadcast(&waiter->m_Condition);
+        }
     }
 }
 }
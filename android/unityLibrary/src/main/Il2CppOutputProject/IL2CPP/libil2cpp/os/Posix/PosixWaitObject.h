@@ -24,6 +24,18 @@ namespace posix
 {
     const uint32_t kNoTimeout = UINT_MAX;
 
+    class PosixWaitObject;
+
+/// Registration of a multi-object wait (Handle::WaitAny/WaitAll) on a single wait object. Whenever
+/// the object gets signaled, the listening waiter object is signaled as well so that the waiting
+/// thread wakes up and retries acquiring its handles.
+    struct PosixWaitObjectListener
+    {
+        PosixWaitObject* waiter;
+        PosixWaitObjectListener* next;
+        PosixWaitObjectListener* previous;
+    };
+
 
 ////TODO: generalize this so that it can be used with c++11 condition variables
 
@@ -48,8 +60,14 @@ namespace posix
         /// back to waiting except if the wait timeout has expired.
         void InterruptWait();
 
+        /// Returns the wait object itself. Used by the generic multi-object waits to get from an
+        /// os::Handle to the object they have to register a listener on.
         void* GetOSHandle();
 
+        /// Add or remove a listener to be notified whenever this object becomes signaled.
+        void AddListener(PosixWaitObjectListener* listener);
+        void RemoveListener(PosixWaitObjectListener* listener);
+
         static void LockWaitObjectDeletion();
         static void UnlockWaitObjectDeletion();
 
@@ -82,7 +100,20 @@ namespace posix
         /// on m_Condition.
         uint32_t m_WaitingThreadCount;
 
+        /// Multi-object waits currently listening on this object. Protected by m_Mutex.
+        PosixWaitObjectListener* m_Listeners;
+
         bool HaveWaitingThreads() const { return (m_WaitingThreadCount != 0); }
+
+        /// Wake up all multi-object waits listening on this object. Must be called with m_Mutex held.
+        void NotifyListeners()
+        {
+            if (m_Listeners != NULL)
+                NotifyListenersSlow();
+        }
+
+    private:
+        void NotifyListenersSlow();
     };
 
     struct AutoLockWaitObjectDeletion
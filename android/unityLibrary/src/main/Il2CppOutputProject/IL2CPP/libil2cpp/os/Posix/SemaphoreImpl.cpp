@@ -34,6 +34,7 @@ namespace os
             m_Count += releaseCount;
 
             pthread_cond_signal(&m_Condition);
+            NotifyListeners();
         }
 
         if (previousCount)
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "os/Atomic.h"
+#include "utils/Memory.h"
+#include "utils/NonCopyable.h"
+
+namespace il2cpp
+{
+namespace utils
+{
+    // Insert-only, open addressing hash set of pointers whose lookups never take a lock.
+    //
+    // Entries are published with a release fence and a grown table is only published once it
+    // holds every entry, so a reader either finds an entry or sees a table that lacks the most
+    // recent ones. Callers treat a miss as "take the lock and look again", which is also the only
+    // place they call Add: writers must be serialized by the caller. Replaced tables are kept
+    // until Clear because readers may still be probing them; they add up to less than the
+    // current table.
+    //
+    // Traits provides key_type, GetKey(T), Hash(key_type) and Equals(key_type, key_type).
+    template<typename T, typename Traits>
+    class ConcurrentAppendOnlyHashSet : public il2cpp::utils::NonCopyable
+    {
+    public:
+        typedef typename Traits::key_type key_type;
+        typedef void (*ForEachCallback)(T value, void* context);
+
+        ConcurrentAppendOnlyHashSet() :
+            m_Table(NULL),
+            m_Count(0)
+        {
+        }
+
+        ~ConcurrentAppendOnlyHashSet()
+        {
+            Clear();
+        }
+
+        bool TryGet(const key_type& key, T* value)
+        {
+            Table* table = os::Atomic::ReadPointer(&m_Table);
+            if (table == NULL)
+                return false;
+
+            for (size_t i = Traits::Hash(key) & table->mask;; i = (i + 1) & table->mask)
+            {
+                T entry = os::Atomic::ReadPointer(&table->entries[i]);
+                if (entry == NULL)
+                    return false;
+
+                if (Traits::Equals(key, Traits::GetKey(entry)))
+                {
+                    *value = entry;
+                    return true;
+                }
+            }
+        }
+
+        // Must be serialized with other calls to Add, Reserve and Clear.
+        bool Add(T value)
+        {
+            T existing;
+            if (TryGet(Traits::GetKey(value), &existing))
+                return false;
+
+            if (m_Table == NULL || (m_Count + 1) * 2 > m_Table->mask + 1)
+                Grow(m_Count + 1);
+
+            Insert(m_Table, value, true);
+            m_Count++;
+            return true;
+        }
+
+        void Reserve(size_t count)
+        {
+            if (m_Table == NULL || count * 2 > m_Table->mask + 1)
+                Grow(count);
+        }
+
+        // Not safe against concurrent readers; only for shutdown.
+        void Clear()
+        {
+            Table* table = m_Table;
+            while (table != NULL)
+            {
+                Table* previous = table->previous;
+                IL2CPP_FREE(table);
+                table = previous;
+            }
+
+            m_Table = NULL;
+            m_Count = 0;
+        }
+
+        // Walks the entries present when called; must be serialized with Add.
+        void ForEach(ForEachCallback callback, void* context)
+        {
+            if (m_Table == NULL)
+                return;
+
+            for (size_t i = 0; i <= m_Table->mask; i++)
+            {
+                if (m_Table->entries[i] != NULL)
+                    callback(m_Table->entries[i], context);
+            }
+        }
+
+        size_t Count() const
+        {
+            return m_Count;
+        }
+
+    private:
+        struct Table
+        {
+            Table* previous;
+            size_t mask;
+            T entries[1];
+        };
+
+        static void Insert(Table* table, T value, bool publish)
+        {
+            size_t i = Traits::Hash(Traits::GetKey(value)) & table->mask;
+            while (table->entries[i] != NULL)
+                i = (i + 1) & table->mask;
+
+            if (publish)
+                os::Atomic::PublishPointer(&table->entries[i], value);
+            else
+                table->entries[i] = value;
+        }
+
+        // Keeps the load factor at or below one half so probes always reach an empty slot.
+        void Grow(size_t count)
+        {
+            size_t capacity = 16;
+            while (capacity < count * 2)
+                capacity *= 2;
+
+            Table* table = (Table*)IL2CPP_CALLOC(1, sizeof(Table) + (capacity - 1) * sizeof(T));
+            table->mask = capacity - 1;
+            table->previous = m_Table;
+
+            if (m_Table != NULL)
+            {
+                for (size_t i = 0; i <= m_Table->mask; i++)
+                {
+                    if (m_Table->entries[i] != NULL)
+                        Insert(table, m_Table->entries[i], false);
+                }
+            }
+
+            os::Atomic::PublishPointer(&m_Table, table);
+        }
+
+        Table* m_Table;
+        size_t m_Count;
+    };
+} /* namespace utils */
+} /* namespace il2cpp */
@@ -8,12 +8,29 @@
 #include "vm/Profiler.h"
 #include "il2cpp-class-internals.h"
 #include "il2cpp-object-internals.h"
+#include <limits>
 #include <memory>
 
 namespace il2cpp
 {
 namespace vm
 {
+#if !RUNTIME_TINY
+    // Arrays of value types whose layout has a precise descriptor (a bitmap, or an extended
+    // descriptor for large structs) are allocated as gcj vectors, so the marker applies the
+    // element descriptor to each element instead of scanning the whole array conservatively.
+    static inline bool HasPreciseValueTypeElements(Il2CppClass* arrayClass)
+    {
+        Il2CppClass* elementClass = arrayClass->element_class;
+        if (!elementClass->byval_arg.valuetype)
+            return false;
+
+        GC_descr elementDescriptor = (GC_descr)elementClass->gc_desc;
+        return (elementDescriptor & GC_DS_TAGS) == GC_DS_BITMAP || (elementDescriptor & GC_DS_TAGS) == GC_DS_PROC;
+    }
+
+#endif
+
     Il2CppArray* Array::Clone(Il2CppArray* arr)
     {
         Il2CppClass *typeInfo = arr->klass;
@@ -90,6 +107,16 @@ namespace vm
         vm::Exception::Raise(vm::Exception::GetOverflowException("Arithmetic operation resulted in an overflow."));
     }
 
+    static inline bool CheckMulOverflow(il2cpp_array_size_t a, il2cpp_array_size_t b)
+    {
+        return b != 0 && a > std::numeric_limits<il2cpp_array_size_t>::max() / b;
+    }
+
+    static inline bool CheckAddOverflow(il2cpp_array_size_t a, il2cpp_array_size_t b)
+    {
+        return a > std::numeric_limits<il2cpp_array_size_t>::max() - b;
+    }
+
     Il2CppArray* Array::NewSpecific(Il2CppClass *klass, il2cpp_array_size_t n)
     {
         Il2CppObject *o;
@@ -103,9 +130,6 @@ namespace vm
         IL2CPP_ASSERT(klass->element_class->initialized);
         IL2CPP_ASSERT(klass->byval_arg.type == IL2CPP_TYPE_SZARRAY);
 
-        IL2CPP_NOT_IMPLEMENTED_NO_ASSERT(Array::NewSpecific, "Not checking for overflow");
-        IL2CPP_NOT_IMPLEMENTED_NO_ASSERT(Array::NewSpecific, "Handle allocations with a GC descriptor");
-
         if (n > IL2CPP_ARRAY_MAX_INDEX)
         {
             RaiseOverflowException();
@@ -113,27 +137,18 @@ namespace vm
         }
 
         elem_size = il2cpp_array_element_size(klass);
-        //if (CHECK_MUL_OVERFLOW_UN (n, elem_size)) {
-        //  mono_gc_out_of_memory (MONO_ARRAY_MAX_SIZE);
-        //  return NULL;
-        //}
+        if (CheckMulOverflow(n, elem_size))
+            Exception::RaiseOutOfMemoryException();
         byte_len = n * elem_size;
-        //if (CHECK_ADD_OVERFLOW_UN (byte_len, sizeof (MonoArray))) {
-        //  mono_gc_out_of_memory (MONO_ARRAY_MAX_SIZE);
-        //  return NULL;
-        //}
+        if (CheckAddOverflow(byte_len, kIl2CppSizeOfArray))
+            Exception::RaiseOutOfMemoryException();
         byte_len += kIl2CppSizeOfArray;
         if (!klass->has_references)
         {
-            o = Object::AllocatePtrFree(byte_len, klass);
-#if NEED_TO_ZERO_PTRFREE
-            ((Il2CppArray*)o)->bounds = NULL;
-            memset((char*)o + sizeof(Il2CppObject), 0, byte_len - sizeof(Il2CppObject));
-#endif
+            o = Object::AllocatePtrFreeZeroed(byte_len, klass);
         }
 #if !RUNTIME_TINY
-        else if (klass->element_class->byval_arg.valuetype &&
-                 ((GC_descr)klass->element_class->gc_desc & GC_DS_TAGS) == GC_DS_BITMAP)
+        else if (HasPreciseValueTypeElements(klass))
         {
             o = (Il2CppObject*)GC_gcj_vector_malloc(byte_len, klass);
         }
@@ -173,7 +188,6 @@ namespace vm
         IL2CPP_ASSERT(array_class->element_class->initialized);
 
         IL2CPP_NOT_IMPLEMENTED_NO_ASSERT(Array::NewFull, "IGNORING non-zero based arrays!");
-        IL2CPP_NOT_IMPLEMENTED_NO_ASSERT(Array::NewFull, "Handle allocations with a GC descriptor");
 
         byte_len = il2cpp_array_element_size(array_class);
         len = 1;
@@ -200,26 +214,26 @@ namespace vm
             {
                 if (lengths[i] > IL2CPP_ARRAY_MAX_INDEX)  //MONO_ARRAY_MAX_INDEX
                     RaiseOverflowException();
-                //if (CHECK_MUL_OVERFLOW_UN (len, lengths [i]))
-                //  mono_gc_out_of_memory (MONO_ARRAY_MAX_SIZE);
+                if (CheckMulOverflow(len, lengths[i]))
+                    Exception::RaiseOutOfMemoryException();
                 len *= lengths[i];
             }
         }
 
-        //if (CHECK_MUL_OVERFLOW_UN (byte_len, len))
-        //  mono_gc_out_of_memory (MONO_ARRAY_MAX_SIZE);
+        if (CheckMulOverflow(byte_len, len))
+            Exception::RaiseOutOfMemoryException();
         byte_len *= len;
-        //if (CHECK_ADD_OVERFLOW_UN (byte_len, sizeof (MonoArray)))
-        //  mono_gc_out_of_memory (MONO_ARRAY_MAX_SIZE);
+        if (CheckAddOverflow(byte_len, kIl2CppSizeOfArray))
+            Exception::RaiseOutOfMemoryException();
         byte_len += kIl2CppSizeOfArray;
         if (bounds_size)
         {
             /* align */
-            //if (CHECK_ADD_OVERFLOW_UN (byte_len, 3))
-            //  mono_gc_out_of_memory (MONO_ARRAY_MAX_SIZE);
+            if (CheckAddOverflow(byte_len, IL2CPP_SIZEOF_VOID_P - 1))
+                Exception::RaiseOutOfMemoryException();
             byte_len = (byte_len + (IL2CPP_SIZEOF_VOID_P - 1)) & ~(IL2CPP_SIZEOF_VOID_P - 1);
-            //if (CHECK_ADD_OVERFLOW_UN (byte_len, bounds_size))
-            //  mono_gc_out_of_memory (MONO_ARRAY_MAX_SIZE);
+            if (CheckAddOverflow(byte_len, bounds_size))
+                Exception::RaiseOutOfMemoryException();
             byte_len += bounds_size;
         }
         /*
@@ -228,11 +242,16 @@ namespace vm
          */
         if (!array_class->has_references)
         {
-            o = Object::AllocatePtrFree(byte_len, array_class);
-#if NEED_TO_ZERO_PTRFREE
-            memset((char*)o + sizeof(Il2CppObject), 0, byte_len - sizeof(Il2CppObject));
-#endif
+            o = Object::AllocatePtrFreeZeroed(byte_len, array_class);
         }
+#if !RUNTIME_TINY
+        else if (HasPreciseValueTypeElements(array_class))
+        {
+            // The elements start at the same offset for every rank, and the bounds stored after
+            // them hold no references, so the vector mark procedure only needs the total length.
+            o = (Il2CppObject*)GC_gcj_vector_malloc(byte_len, array_class);
+        }
+#endif
 #if IL2CPP_HAS_GC_DESCRIPTORS
         else if (array_class->gc_desc != GC_NO_DESCRIPTOR)
         {
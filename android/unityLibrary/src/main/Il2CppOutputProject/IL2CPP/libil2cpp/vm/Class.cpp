@@ -9,6 +9,7 @@
 #include "metadata/Il2CppTypeCompare.h"
 #include "os/Atomic.h"
 #include "os/Mutex.h"
+#include "utils/ConcurrentAppendOnlyHashSet.h"
 #include "utils/Memory.h"
 #include "utils/StringUtils.h"
 #include "vm/Assembly.h"
@@ -412,38 +413,111 @@ namespace vm
         return GetMethodFromNameFlagsAndSig(klass, name, argsCount, flags, NULL);
     }
 
+    // Open addressing table of a class's methods and those of its parents, hashed on the method
+    // name. Methods are inserted in lookup order (the class first, then each parent) and linear
+    // probing keeps that order among methods sharing a probe chain, so the first match found is
+    // the one a walk of the hierarchy would find.
+    struct MethodNameIndex
+    {
+        const Il2CppClass* klass;
+        size_t mask;
+        const MethodInfo* methods[1];
+    };
+
+    struct MethodNameIndexTraits
+    {
+        typedef const Il2CppClass* key_type;
+        static key_type GetKey(const MethodNameIndex* index) { return index->klass; }
+        static size_t Hash(key_type key) { return il2cpp::utils::HashUtils::AlignedPointerHash(key); }
+        static bool Equals(key_type left, key_type right) { return left == right; }
+    };
+
+    typedef il2cpp::utils::ConcurrentAppendOnlyHashSet<const MethodNameIndex*, MethodNameIndexTraits> MethodNameIndexSet;
+    static MethodNameIndexSet s_MethodNameIndices;
+
+    static MethodNameIndex* BuildMethodNameIndexLocked(Il2CppClass* klass, const il2cpp::os::FastAutoLock& lock)
+    {
+        size_t methodCount = 0;
+        for (Il2CppClass* current = klass; current != NULL; current = current->parent)
+        {
+            Class::SetupMethods(current);
+            methodCount += current->method_count;
+        }
+
+        size_t capacity = 8;
+        while (capacity < methodCount * 2)
+            capacity *= 2;
+
+        MethodNameIndex* index = (MethodNameIndex*)MetadataCalloc(1, sizeof(MethodNameIndex) + (capacity - 1) * sizeof(const MethodInfo*));
+        index->klass = klass;
+        index->mask = capacity - 1;
+
+        for (Il2CppClass* current = klass; current != NULL; current = current->parent)
+        {
+            for (uint16_t i = 0; i < current->method_count; i++)
+            {
+                const MethodInfo* method = current->methods[i];
+                size_t slot = il2cpp::utils::StringUtils::Hash(method->name) & index->mask;
+                while (index->methods[slot] != NULL)
+                    slot = (slot + 1) & index->mask;
+                index->methods[slot] = method;
+            }
+        }
+
+        return index;
+    }
+
+    static const MethodNameIndex* GetMethodNameIndex(Il2CppClass* klass)
+    {
+        const MethodNameIndex* index;
+        if (s_MethodNameIndices.TryGet(klass, &index))
+            return index;
+
+        il2cpp::os::FastAutoLock lock(&g_MetadataLock);
+
+        // Check if the index was built while we were waiting for the g_MetadataLock
+        if (s_MethodNameIndices.TryGet(klass, &index))
+            return index;
+
+        MethodNameIndex* newIndex = BuildMethodNameIndexLocked(klass, lock);
+        s_MethodNameIndices.Add(newIndex);
+        return newIndex;
+    }
+
+    void Class::ClearMethodNameIndices()
+    {
+        s_MethodNameIndices.Clear();
+    }
+
     const MethodInfo* Class::GetMethodFromNameFlagsAndSig(Il2CppClass *klass, const char* name, int argsCount, int32_t flags, const Il2CppType** argTypes)
     {
         Class::Init(klass);
 
-        while (klass != NULL)
+        const MethodNameIndex* index = GetMethodNameIndex(klass);
+        for (size_t slot = il2cpp::utils::StringUtils::Hash(name) & index->mask;; slot = (slot + 1) & index->mask)
         {
-            void* iter = NULL;
-            while (const MethodInfo* method = Class::GetMethods(klass, &iter))
+            const MethodInfo* method = index->methods[slot];
+            if (method == NULL)
+                return NULL;
+
+            if (method->name[0] == name[0] &&
+                (argsCount == IgnoreNumberOfArguments || method->parameters_count == argsCount) &&
+                ((method->flags & flags) == flags) &&
+                !strcmp(name, method->name))
             {
-                if (method->name[0] == name[0] &&
-                    (argsCount == IgnoreNumberOfArguments || method->parameters_count == argsCount) &&
-                    ((method->flags & flags) == flags) &&
-                    !strcmp(name, method->name))
+                bool allArgTypeMatch = true;
+                if (argTypes != NULL && argsCount != IgnoreNumberOfArguments)
                 {
-                    bool allArgTypeMatch = true;
-                    if (argTypes != NULL && argsCount != IgnoreNumberOfArguments)
+                    for (int i = 0; allArgTypeMatch && i < argsCount; i++)
                     {
-                        for (int i = 0; allArgTypeMatch && i < argsCount; i++)
-                        {
-                            allArgTypeMatch = metadata::Il2CppTypeEqualityComparer::AreEqual(method->parameters[i], argTypes[i]);
-                        }
+                        allArgTypeMatch = metadata::Il2CppTypeEqualityComparer::AreEqual(method->parameters[i], argTypes[i]);
                     }
-
-                    if (allArgTypeMatch)
-                        return method;
                 }
-            }
 
-            klass = klass->parent;
+                if (allArgTypeMatch)
+                    return method;
+            }
         }
-
-        return NULL;
     }
 
     const MethodInfo* Class::GetGenericInstanceMethodFromDefintion(Il2CppClass* genericInstanceClass, const MethodInfo* methodDefinition)
@@ -1197,6 +1271,37 @@ namespace vm
         }
     }
 
+    // Below this many interfaces a linear scan of interfaceOffsets beats hashing
+    static const uint16_t kInterfaceOffsetTableMinimumCount = 8;
+
+    static void SetupInterfaceOffsetTable(Il2CppClass *klass)
+    {
+        if (klass->interface_offsets_count < kInterfaceOffsetTableMinimumCount || klass->interfaceOffsetTable != NULL)
+            return;
+
+        uint32_t size = 1;
+        while (size < 2u * klass->interface_offsets_count)
+            size <<= 1;
+
+        Il2CppRuntimeInterfaceOffsetTable* table = (Il2CppRuntimeInterfaceOffsetTable*)MetadataCalloc(1, sizeof(Il2CppRuntimeInterfaceOffsetTable) + size * sizeof(Il2CppRuntimeInterfaceOffsetPair));
+        table->mask = size - 1;
+
+        for (uint16_t i = 0; i < klass->interface_offsets_count; i++)
+        {
+            const Il2CppRuntimeInterfaceOffsetPair& pair = klass->interfaceOffsets[i];
+            uint32_t index = ClassInlines::InterfaceOffsetTableHash(pair.interfaceType) & table->mask;
+
+            // The first entry for an interface wins, the same as the linear scan
+            while (table->entries[index].interfaceType != NULL && table->entries[index].interfaceType != pair.interfaceType)
+                index = (index + 1) & table->mask;
+
+            if (table->entries[index].interfaceType == NULL)
+                table->entries[index] = pair;
+        }
+
+        klass->interfaceOffsetTable = table;
+    }
+
     static void SetupVTable(Il2CppClass *klass, const il2cpp::os::FastAutoLock& lock)
     {
         if (klass->is_vtable_initialized)
@@ -1301,6 +1406,8 @@ namespace vm
             }
         }
 
+        SetupInterfaceOffsetTable(klass);
+
         klass->is_vtable_initialized = 1;
     }
 
@@ -1536,6 +1643,7 @@ namespace vm
         Class::PublishInitialized(klass);
 
         ++il2cpp_runtime_stats.initialized_class_count;
+        MetadataCache::RecordClassInitialized(klass);
 
         return true;
     }
@@ -145,6 +145,7 @@ namespace vm
 
         static void SetClassInitializationError(Il2CppClass* klass, Il2CppException* error);
         static void PublishInitialized(Il2CppClass* klass);
+        static void ClearMethodNameIndices();
 
         static IL2CPP_FORCE_INLINE bool IsGenericClassAssignableFrom(const Il2CppClass* klass, const Il2CppClass* oklass, const Il2CppClass* implementingClass = il2cpp_defaults.missing_class)
         {
@@ -5,11 +5,27 @@
 #include "vm/RCW.h"
 #include "gc/GCHandle.h"
 #include "metadata/GenericMethod.h"
+#include "utils/HashUtils.h"
+#include "utils/Il2CppHashMap.h"
 
 namespace il2cpp
 {
 namespace vm
 {
+    typedef std::pair<const Il2CppClass*, const Il2CppClass*> VarianceKey;
+
+    struct VarianceKeyHash
+    {
+        size_t operator()(const VarianceKey& key) const
+        {
+            return il2cpp::utils::HashUtils::Combine(il2cpp::utils::HashUtils::AlignedPointerHash(key.first), il2cpp::utils::HashUtils::AlignedPointerHash(key.second));
+        }
+    };
+
+    // Remembers which vtable offset (or -1 for none) a variant interface lookup resolved to for a class
+    typedef Il2CppReaderWriterLockedHashMap<VarianceKey, int32_t, VarianceKeyHash> VarianceOffsetMap;
+    static VarianceOffsetMap s_VarianceOffsetMap;
+
     Il2CppClass* ClassInlines::InitFromCodegenSlow(Il2CppClass *klass)
     {
         IL2CPP_ASSERT(klass != il2cpp_defaults.il2cpp_fully_shared_type);
@@ -51,24 +67,77 @@ namespace vm
         Exception::Raise(il2cpp::vm::Exception::GetMethodAccessException(message.c_str()));
     }
 
+    // Classes with many interfaces get an interfaceOffsetTable in Class::Init, a linear scan is faster for the rest
+    static const Il2CppRuntimeInterfaceOffsetPair* FindInterfaceOffset(const Il2CppClass* klass, const Il2CppClass* itf)
+    {
+        const Il2CppRuntimeInterfaceOffsetTable* table = klass->interfaceOffsetTable;
+        if (table != NULL)
+        {
+            for (uint32_t i = ClassInlines::InterfaceOffsetTableHash(itf) & table->mask;; i = (i + 1) & table->mask)
+            {
+                const Il2CppRuntimeInterfaceOffsetPair* pair = table->entries + i;
+                if (pair->interfaceType == itf)
+                    return pair;
+                if (pair->interfaceType == NULL)
+                    return NULL;
+            }
+        }
+
+        for (uint16_t i = 0; i < klass->interface_offsets_count; i++)
+        {
+            if (klass->interfaceOffsets[i].interfaceType == itf)
+                return klass->interfaceOffsets + i;
+        }
+
+        return NULL;
+    }
+
     const VirtualInvokeData* ClassInlines::GetInterfaceInvokeDataFromVTableSlowPath(const Il2CppClass* klass, const Il2CppClass* itf, Il2CppMethodSlot slot)
     {
+        const Il2CppRuntimeInterfaceOffsetPair* pair = FindInterfaceOffset(klass, itf);
+        if (pair != NULL)
+        {
+            int32_t offset = pair->offset;
+            IL2CPP_ASSERT(offset != -1);
+            IL2CPP_ASSERT(offset + slot < klass->vtable_count);
+            return &klass->vtable[offset + slot];
+        }
+
         if (itf->generic_class != NULL)
         {
-            for (uint16_t i = 0; i < klass->interface_offsets_count; ++i)
+            VarianceKey key(klass, itf);
+            int32_t offset;
+            if (!s_VarianceOffsetMap.TryGet(key, &offset))
             {
-                const Il2CppRuntimeInterfaceOffsetPair* pair = klass->interfaceOffsets + i;
-                if (Class::IsGenericClassAssignableFromVariance(itf, pair->interfaceType, klass))
+                offset = -1;
+                for (uint16_t i = 0; i < klass->interface_offsets_count; ++i)
                 {
-                    IL2CPP_ASSERT(pair->offset + slot < klass->vtable_count);
-                    return &klass->vtable[pair->offset + slot];
+                    const Il2CppRuntimeInterfaceOffsetPair* pair = klass->interfaceOffsets + i;
+                    if (Class::IsGenericClassAssignableFromVariance(itf, pair->interfaceType, klass))
+                    {
+                        offset = pair->offset;
+                        break;
+                    }
                 }
+
+                s_VarianceOffsetMap.Add(key, offset);
+            }
+
+            if (offset != -1)
+            {
+                IL2CPP_ASSERT(offset + slot < klass->vtable_count);
+                return &klass->vtable[offset + slot];
             }
         }
 
         return NULL;
     }
 
+    void ClassInlines::ClearInterfaceVarianceCache()
+    {
+        s_VarianceOffsetMap.Clear();
+    }
+
     const VirtualInvokeData& ClassInlines::GetInterfaceInvokeDataFromVTableSlowPath(Il2CppObject* obj, const Il2CppClass* itf, Il2CppMethodSlot slot)
     {
         const Il2CppClass* klass = obj->klass;
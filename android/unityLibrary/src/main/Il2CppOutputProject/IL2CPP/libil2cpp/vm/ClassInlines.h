@@ -42,15 +42,12 @@ namespace vm
             IL2CPP_ASSERT(klass->initialized);
             IL2CPP_ASSERT(slot < itf->method_count);
 
-            for (uint16_t i = 0; i < klass->interface_offsets_count; i++)
+            if (klass->interface_offsets_count != 0 && klass->interfaceOffsets[0].interfaceType == itf)
             {
-                if (klass->interfaceOffsets[i].interfaceType == itf)
-                {
-                    int32_t offset = klass->interfaceOffsets[i].offset;
-                    IL2CPP_ASSERT(offset != -1);
-                    IL2CPP_ASSERT(offset + slot < klass->vtable_count);
-                    return klass->vtable[offset + slot];
-                }
+                int32_t offset = klass->interfaceOffsets[0].offset;
+                IL2CPP_ASSERT(offset != -1);
+                IL2CPP_ASSERT(offset + slot < klass->vtable_count);
+                return klass->vtable[offset + slot];
             }
 
             return GetInterfaceInvokeDataFromVTableSlowPath(obj, itf, slot);
@@ -61,23 +58,27 @@ namespace vm
             IL2CPP_ASSERT(klass->is_vtable_initialized);
             IL2CPP_ASSERT(slot < itf->method_count);
 
-            for (uint16_t i = 0; i < klass->interface_offsets_count; i++)
+            if (klass->interface_offsets_count != 0 && klass->interfaceOffsets[0].interfaceType == itf)
             {
-                if (klass->interfaceOffsets[i].interfaceType == itf)
-                {
-                    int32_t offset = klass->interfaceOffsets[i].offset;
-                    IL2CPP_ASSERT(offset != -1);
-                    IL2CPP_ASSERT(offset + slot < klass->vtable_count);
-                    return &klass->vtable[offset + slot];
-                }
+                int32_t offset = klass->interfaceOffsets[0].offset;
+                IL2CPP_ASSERT(offset != -1);
+                IL2CPP_ASSERT(offset + slot < klass->vtable_count);
+                return &klass->vtable[offset + slot];
             }
 
             return GetInterfaceInvokeDataFromVTableSlowPath(klass, itf, slot);
         }
 
+        static IL2CPP_FORCE_INLINE uint32_t InterfaceOffsetTableHash(const Il2CppClass* itf)
+        {
+            uintptr_t value = (uintptr_t)itf;
+            return (uint32_t)((value >> 3) ^ (value >> 11));
+        }
+
         // we don't want this method to get inlined because that makes GetInterfaceInvokeDataFromVTable method itself very large and performance suffers
         static IL2CPP_NO_INLINE const VirtualInvokeData& GetInterfaceInvokeDataFromVTableSlowPath(Il2CppObject* obj, const Il2CppClass* itf, Il2CppMethodSlot slot);
         static IL2CPP_NO_INLINE const VirtualInvokeData* GetInterfaceInvokeDataFromVTableSlowPath(const Il2CppClass* klass, const Il2CppClass* itf, Il2CppMethodSlot slot);
+        static void ClearInterfaceVarianceCache();
     };
 }
 }
@@ -3,8 +3,10 @@
 #include "il2cpp-config.h"
 
 
+#include <algorithm>
 #include <map>
 #include <limits>
+#include <vector>
 #include <il2cpp-runtime-metadata.h>
 #include "il2cpp-class-internals.h"
 #include "il2cpp-tabledefs.h"
@@ -25,7 +27,10 @@
 #include "metadata/Il2CppGenericMethodHash.h"
 #include "metadata/Il2CppSignature.h"
 #include "os/Atomic.h"
+#include "os/Environment.h"
+#include "os/File.h"
 #include "os/Mutex.h"
+#include "os/Thread.h"
 #include "utils/CallOnce.h"
 #include "utils/Collections.h"
 #include "utils/HashUtils.h"
@@ -38,6 +43,7 @@
 #include "vm/Assembly.h"
 #include "vm/Class.h"
 #include "vm/ClassInlines.h"
+#include "vm/Domain.h"
 #include "vm/GenericClass.h"
 #include "vm/MetadataAlloc.h"
 #include "vm/MetadataLoader.h"
@@ -46,6 +52,7 @@
 #include "vm/Method.h"
 #include "vm/Object.h"
 #include "vm/String.h"
+#include "vm/Thread.h"
 #include "vm/Type.h"
 #include "vm-utils/MethodDefinitionKey.h"
 #include "vm-utils/NativeSymbol.h"
@@ -94,6 +101,19 @@ static const Il2CppMetadataRegistration * s_Il2CppMetadataRegistration;
 static Il2CppClass** s_TypeInfoTable = NULL;
 static Il2CppClass** s_TypeInfoDefinitionTable = NULL;
 
+static bool s_AccessProfileRecording = false;
+static std::string s_AccessProfileRecordPath;
+static std::string s_AccessProfilePrewarmPath;
+static baselib::ReentrantLock s_AccessProfileMutex;
+static std::vector<uint32_t> s_RecordedUsageTokens;
+static std::vector<TypeDefinitionIndex> s_RecordedTypeDefinitions;
+#if IL2CPP_SUPPORT_THREADS
+static il2cpp::os::Thread* s_AccessProfilePrewarmThread = NULL;
+#endif
+static volatile bool s_AccessProfilePrewarmCancelled = false;
+
+static void RecordMetadataUsage(uint32_t encodedToken);
+
 static const int kBitIsValueType = 1;
 static const int kBitIsEnum = 2;
 static const int kBitHasFinalizer = 3;
@@ -428,11 +448,263 @@ void* il2cpp::vm::GlobalMetadata::InitializeRuntimeMetadata(uintptr_t* metadataP
     {
         // Set the metadata pointer last, with a barrier, so it is the last item written
         il2cpp::os::Atomic::PublishPointer((void**)metadataPointer, initialized);
+
+        if (s_AccessProfileRecording)
+            RecordMetadataUsage(encodedToken);
     }
 
     return initialized;
 }
 
+// The metadata access profile is an opt-in record of the metadata usages and type definitions a run
+// touched. A later run can resolve that set up front (on a background thread by default), so the
+// lazy first-use initialization and its g_MetadataLock traffic happen before gameplay rather than
+// being spread across the first frames.
+//   IL2CPP_METADATA_PROFILE_RECORD=<path>    record this run and write the profile at shutdown
+//   IL2CPP_METADATA_PROFILE_PREWARM=<path>   resolve a recorded profile at startup
+//   IL2CPP_METADATA_PROFILE_PREWARM_BLOCKING resolve it on the main thread before startup continues
+
+static const uint32_t kAccessProfileMagic = 0x504D4349; // 'ICMP'
+static const uint32_t kAccessProfileVersion = 1;
+
+typedef struct Il2CppMetadataAccessProfileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t metadataUsagesCount;
+    uint32_t typeDefinitionsCount;
+    uint32_t usageTokenCount;
+    uint32_t typeDefinitionCount;
+} Il2CppMetadataAccessProfileHeader;
+
+static uint32_t GetTypeDefinitionsCount()
+{
+    return s_GlobalMetadataHeader->typeDefinitionsSize / sizeof(Il2CppTypeDefinition);
+}
+
+static void RecordMetadataUsage(uint32_t encodedToken)
+{
+    il2cpp::os::FastAutoLock lock(&s_AccessProfileMutex);
+    s_RecordedUsageTokens.push_back(encodedToken);
+}
+
+// Only classes that come straight from a type definition can be named in the profile. Generic
+// instances, arrays and pointers are reached again through the metadata usages that created them.
+static bool TryGetIndexForTypeDefinition(const Il2CppClass* klass, TypeDefinitionIndex* index)
+{
+    if (klass->generic_class != NULL || klass->rank != 0 || klass->typeMetadataHandle == NULL)
+        return false;
+
+    switch (klass->byval_arg.type)
+    {
+        case IL2CPP_TYPE_PTR:
+        case IL2CPP_TYPE_FNPTR:
+        case IL2CPP_TYPE_VAR:
+        case IL2CPP_TYPE_MVAR:
+            return false;
+        default:
+            break;
+    }
+
+    const Il2CppTypeDefinition* typeDefinitions = (const Il2CppTypeDefinition*)((const char*)s_GlobalMetadata + s_GlobalMetadataHeader->typeDefinitionsOffset);
+    const Il2CppTypeDefinition* typeDefinition = reinterpret_cast<const Il2CppTypeDefinition*>(klass->typeMetadataHandle);
+    if (typeDefinition < typeDefinitions || typeDefinition >= typeDefinitions + GetTypeDefinitionsCount())
+        return false;
+
+    *index = static_cast<TypeDefinitionIndex>(typeDefinition - typeDefinitions);
+    return s_TypeInfoDefinitionTable[*index] == klass;
+}
+
+void il2cpp::vm::GlobalMetadata::RecordClassInitialized(const Il2CppClass* klass)
+{
+    if (!s_AccessProfileRecording)
+        return;
+
+    TypeDefinitionIndex index;
+    if (!TryGetIndexForTypeDefinition(klass, &index))
+        return;
+
+    il2cpp::os::FastAutoLock lock(&s_AccessProfileMutex);
+    s_RecordedTypeDefinitions.push_back(index);
+}
+
+template<typename T>
+static void SortAndRemoveDuplicates(std::vector<T>& values)
+{
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+}
+
+static bool ReadAccessProfile(const std::string& path, std::vector<uint32_t>& usageTokens, std::vector<TypeDefinitionIndex>& typeDefinitions)
+{
+    int error = 0;
+    il2cpp::os::FileHandle* handle = il2cpp::os::File::Open(path, kFileModeOpen, kFileAccessRead, kFileShareRead, kFileOptionsNone, &error);
+    if (error != 0)
+        return false;
+
+    bool succeeded = false;
+    Il2CppMetadataAccessProfileHeader header;
+    if (il2cpp::os::File::Read(handle, (char*)&header, sizeof(header), &error) == sizeof(header)
+        && header.magic == kAccessProfileMagic
+        && header.version == kAccessProfileVersion
+        && header.metadataUsagesCount == static_cast<uint32_t>(s_Il2CppMetadataRegistration->metadataUsagesCount)
+        && header.typeDefinitionsCount == GetTypeDefinitionsCount()
+        && header.usageTokenCount <= header.metadataUsagesCount
+        && header.typeDefinitionCount <= header.typeDefinitionsCount)
+    {
+        usageTokens.resize(header.usageTokenCount);
+        typeDefinitions.resize(header.typeDefinitionCount);
+
+        int usageTokensSize = static_cast<int>(usageTokens.size() * sizeof(uint32_t));
+        int typeDefinitionsSize = static_cast<int>(typeDefinitions.size() * sizeof(TypeDefinitionIndex));
+        succeeded = (usageTokensSize == 0 || il2cpp::os::File::Read(handle, (char*)&usageTokens[0], usageTokensSize, &error) == usageTokensSize)
+            && (typeDefinitionsSize == 0 || il2cpp::os::File::Read(handle, (char*)&typeDefinitions[0], typeDefinitionsSize, &error) == typeDefinitionsSize);
+    }
+
+    il2cpp::os::File::Close(handle, &error);
+    return succeeded;
+}
+
+static bool WriteAccessProfile(const std::string& path, const std::vector<uint32_t>& usageTokens, const std::vector<TypeDefinitionIndex>& typeDefinitions)
+{
+    int error = 0;
+    il2cpp::os::FileHandle* handle = il2cpp::os::File::Open(path, kFileModeCreate, kFileAccessWrite, kFileShareNone, kFileOptionsNone, &error);
+    if (error != 0)
+        return false;
+
+    Il2CppMetadataAccessProfileHeader header;
+    header.magic = kAccessProfileMagic;
+    header.version = kAccessProfileVersion;
+    header.metadataUsagesCount = static_cast<uint32_t>(s_Il2CppMetadataRegistration->metadataUsagesCount);
+    header.typeDefinitionsCount = GetTypeDefinitionsCount();
+    header.usageTokenCount = static_cast<uint32_t>(usageTokens.size());
+    header.typeDefinitionCount = static_cast<uint32_t>(typeDefinitions.size());
+
+    int usageTokensSize = static_cast<int>(usageTokens.size() * sizeof(uint32_t));
+    int typeDefinitionsSize = static_cast<int>(typeDefinitions.size() * sizeof(TypeDefinitionIndex));
+    bool succeeded = il2cpp::os::File::Write(handle, (const char*)&header, sizeof(header), &error) == sizeof(header)
+        && (usageTokensSize == 0 || il2cpp::os::File::Write(handle, (const char*)&usageTokens[0], usageTokensSize, &error) == usageTokensSize)
+        && (typeDefinitionsSize == 0 || il2cpp::os::File::Write(handle, (const char*)&typeDefinitions[0], typeDefinitionsSize, &error) == typeDefinitionsSize);
+
+    il2cpp::os::File::Close(handle, &error);
+    return succeeded;
+}
+
+static void PrewarmFromAccessProfile()
+{
+    std::vector<uint32_t> usageTokens;
+    std::vector<TypeDefinitionIndex> typeDefinitions;
+    if (!ReadAccessProfile(s_AccessProfilePrewarmPath, usageTokens, typeDefinitions))
+        return;
+
+    SortAndRemoveDuplicates(usageTokens);
+
+    // Several usage slots can carry the same token, so walk every slot once rather than mapping
+    // tokens back to slots. Reading a slot is cheap compared to the lookups this saves later.
+    for (size_t i = 0; i < s_Il2CppMetadataRegistration->metadataUsagesCount && !s_AccessProfilePrewarmCancelled; i++)
+    {
+        uintptr_t* metadataPointer = reinterpret_cast<uintptr_t*>(s_Il2CppMetadataRegistration->metadataUsages[i]);
+        uintptr_t metadataValue = (uintptr_t)UnityPalReadPtrVal((intptr_t*)metadataPointer);
+        if (il2cpp::vm::GlobalMetadata::IsRuntimeMetadataInitialized(metadataValue))
+            continue;
+
+        if (std::binary_search(usageTokens.begin(), usageTokens.end(), static_cast<uint32_t>(metadataValue)))
+            il2cpp::vm::GlobalMetadata::InitializeRuntimeMetadata(metadataPointer, false);
+    }
+
+    // Classes are initialized in recorded order, which keeps the parents and interfaces an earlier
+    // run initialized first ahead of the classes that need them.
+    uint32_t typeDefinitionsCount = GetTypeDefinitionsCount();
+    for (size_t i = 0; i < typeDefinitions.size() && !s_AccessProfilePrewarmCancelled; i++)
+    {
+        TypeDefinitionIndex index = typeDefinitions[i];
+        if (index < 0 || static_cast<uint32_t>(index) >= typeDefinitionsCount)
+            continue;
+
+        Il2CppClass* klass = il2cpp::vm::GlobalMetadata::GetTypeInfoFromTypeDefinitionIndex(index);
+        if (klass != NULL)
+            il2cpp::vm::Class::Init(klass);
+    }
+}
+
+#if IL2CPP_SUPPORT_THREADS
+static void AccessProfilePrewarmThread(void* arg)
+{
+    Il2CppThread* thread = il2cpp::vm::Thread::Attach(il2cpp::vm::Domain::GetCurrent());
+    s_AccessProfilePrewarmThread->SetName("IL2CPP Metadata Prewarm");
+
+    PrewarmFromAccessProfile();
+
+    il2cpp::vm::Thread::Detach(thread);
+}
+
+#endif
+
+void il2cpp::vm::GlobalMetadata::InitializeAccessProfile()
+{
+    s_AccessProfileRecordPath = il2cpp::os::Environment::GetEnvironmentVariable("IL2CPP_METADATA_PROFILE_RECORD");
+    s_AccessProfilePrewarmPath = il2cpp::os::Environment::GetEnvironmentVariable("IL2CPP_METADATA_PROFILE_PREWARM");
+    s_AccessProfileRecording = !s_AccessProfileRecordPath.empty();
+}
+
+void il2cpp::vm::GlobalMetadata::StartAccessProfilePrewarm()
+{
+    if (s_AccessProfilePrewarmPath.empty())
+        return;
+
+#if IL2CPP_SUPPORT_THREADS
+    if (il2cpp::os::Environment::GetEnvironmentVariable("IL2CPP_METADATA_PROFILE_PREWARM_BLOCKING").empty())
+    {
+        s_AccessProfilePrewarmCancelled = false;
+        s_AccessProfilePrewarmThread = new il2cpp::os::Thread;
+        s_AccessProfilePrewarmThread->Run(&AccessProfilePrewarmThread, NULL);
+        return;
+    }
+#endif
+
+    PrewarmFromAccessProfile();
+}
+
+void il2cpp::vm::GlobalMetadata::ShutdownAccessProfile()
+{
+#if IL2CPP_SUPPORT_THREADS
+    if (s_AccessProfilePrewarmThread != NULL)
+    {
+        s_AccessProfilePrewarmCancelled = true;
+        s_AccessProfilePrewarmThread->Join();
+        delete s_AccessProfilePrewarmThread;
+        s_AccessProfilePrewarmThread = NULL;
+    }
+#endif
+
+    if (!s_AccessProfileRecording)
+        return;
+
+    s_AccessProfileRecording = false;
+
+    il2cpp::os::FastAutoLock lock(&s_AccessProfileMutex);
+
+    SortAndRemoveDuplicates(s_RecordedUsageTokens);
+
+    // Keep the first occurrence of each class so the recorded initialization order survives.
+    std::vector<TypeDefinitionIndex> typeDefinitions;
+    std::vector<bool> seen(GetTypeDefinitionsCount());
+    for (size_t i = 0; i < s_RecordedTypeDefinitions.size(); i++)
+    {
+        TypeDefinitionIndex index = s_RecordedTypeDefinitions[i];
+        if (!seen[index])
+        {
+            seen[index] = true;
+            typeDefinitions.push_back(index);
+        }
+    }
+
+    WriteAccessProfile(s_AccessProfileRecordPath, s_RecordedUsageTokens, typeDefinitions);
+
+    s_RecordedUsageTokens.clear();
+    s_RecordedTypeDefinitions.clear();
+}
+
 void il2cpp::vm::GlobalMetadata::InitializeStringLiteralTable()
 {
     s_StringLiteralTable = (Il2CppString**)il2cpp::gc::GarbageCollector::AllocateFixed(s_GlobalMetadataHeader->stringLiteralSize / sizeof(Il2CppStringLiteral) * sizeof(Il2CppString*), NULL);
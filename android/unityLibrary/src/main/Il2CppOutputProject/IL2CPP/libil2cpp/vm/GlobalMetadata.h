@@ -30,6 +30,10 @@ namespace vm
 
         static void InitializeAllMethodMetadata();
         static void* InitializeRuntimeMetadata(uintptr_t* metadataPointer, bool throwOnError);
+        static void InitializeAccessProfile();
+        static void StartAccessProfilePrewarm();
+        static void ShutdownAccessProfile();
+        static void RecordClassInitialized(const Il2CppClass* klass);
         static void InitializeStringLiteralTable();
         static void InitializeWindowsRuntimeTypeNamesTables(WindowsRuntimeTypeNameToClassMap& windowsRuntimeTypeNameToClassMap, ClassToWindowsRuntimeTypeNameMap& classToWindowsRuntimeTypeNameMap);
         static void InitializeUnresolvedSignatureTable(Il2CppUnresolvedSignatureMap& unresolvedSignatureMap);
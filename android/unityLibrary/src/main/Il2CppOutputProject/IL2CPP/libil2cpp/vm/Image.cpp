@@ -55,7 +55,7 @@ struct NamespaceAndNamePairLess
 struct Il2CppNameToTypeHandleHashTable : public Il2CppHashMap<std::pair<const char*, const char*>, Il2CppMetadataTypeHandle, NamespaceAndNamePairHash, NamespaceAndNamePairEquals>
 {
     typedef Il2CppHashMap<std::pair<const char*, const char*>, Il2CppMetadataTypeHandle, NamespaceAndNamePairHash, NamespaceAndNamePairEquals> Base;
-    Il2CppNameToTypeHandleHashTable() : Base()
+    explicit Il2CppNameToTypeHandleHashTable(size_t expectedCount) : Base(expectedCount)
     {
     }
 };
@@ -150,71 +150,55 @@ namespace vm
 
     static baselib::ReentrantLock s_ClassFromNameMutex;
 
-    static void AddNestedTypesToNametoClassHashTable(Il2CppNameToTypeHandleHashTable* hashTable, const char *namespaze, const std::string& parentName, Il2CppMetadataTypeHandle handle)
-    {
-        std::pair<const char*, const char*> namespaceAndName = MetadataCache::GetTypeNamespaceAndName(handle);
-
-        std::string name = parentName + "/" + namespaceAndName.second;
-        char *pName = (char*)IL2CPP_CALLOC(name.size() + 1, sizeof(char));
-        strcpy(pName, name.c_str());
-
-        hashTable->insert(std::make_pair(std::make_pair(namespaze, (const char*)pName), handle));
-
-        void *iter = NULL;
-        while (Il2CppMetadataTypeHandle nestedClass = MetadataCache::GetNestedTypes(handle, &iter))
-            AddNestedTypesToNametoClassHashTable(hashTable, namespaze, name, nestedClass);
-    }
-
-    static void AddNestedTypesToNametoClassHashTable(const Il2CppImage* image, Il2CppMetadataTypeHandle handle)
-    {
-        std::pair<const char*, const char*> namespaceAndName = MetadataCache::GetTypeNamespaceAndName(handle);
-
-        void *iter = NULL;
-        while (Il2CppMetadataTypeHandle nestedClass = MetadataCache::GetNestedTypes(handle, &iter))
-        {
-            AddNestedTypesToNametoClassHashTable(image->nameToClassHashTable, namespaceAndName.first, namespaceAndName.second, nestedClass);
-        }
-    }
-
 // This must be called when the s_ClassFromNameMutex is held.
     static void AddTypeToNametoClassHashTable(const Il2CppImage* image, Il2CppMetadataTypeHandle typeHandle)
     {
         if (typeHandle == NULL)
             return;
 
-        // don't add nested types
+        // don't add nested types, ClassFromName finds them through their declaring type
         if (MetadataCache::TypeIsNested(typeHandle))
             return;
 
-        if (image != il2cpp_defaults.corlib)
-            AddNestedTypesToNametoClassHashTable(image, typeHandle);
-
         image->nameToClassHashTable->insert(std::make_pair(MetadataCache::GetTypeNamespaceAndName(typeHandle), typeHandle));
     }
 
-    void Image::InitNestedTypes(const Il2CppImage *image)
+    static Il2CppMetadataTypeHandle FindNestedType(Il2CppMetadataTypeHandle declaringType, const char* name, size_t nameLength)
     {
-        for (uint32_t index = 0; index < image->typeCount; index++)
+        void *iter = NULL;
+        while (Il2CppMetadataTypeHandle nestedType = MetadataCache::GetNestedTypes(declaringType, &iter))
         {
-            Il2CppMetadataTypeHandle handle = MetadataCache::GetAssemblyTypeHandle(image, index);
+            const char* nestedName = MetadataCache::GetTypeNamespaceAndName(nestedType).second;
+            if (strncmp(nestedName, name, nameLength) == 0 && nestedName[nameLength] == '\0')
+                return nestedType;
+        }
 
-            // don't add nested types
-            if (MetadataCache::TypeIsNested(handle))
-                return;
+        return NULL;
+    }
 
-            AddNestedTypesToNametoClassHashTable(image, handle);
-        }
+    static Il2CppMetadataTypeHandle FindNestedTypeByPath(const Il2CppImage* image, const char* namespaze, const char* name, const char* nestedSeparator)
+    {
+        // The table is keyed by C strings, so the outer name is terminated in a stack copy rather than a heap string.
+        size_t outerNameLength = nestedSeparator - name;
+        char* outerName = (char*)alloca(outerNameLength + 1);
+        memcpy(outerName, name, outerNameLength);
+        outerName[outerNameLength] = '\0';
 
-        for (uint32_t index = 0; index < image->exportedTypeCount; index++)
-        {
-            Il2CppMetadataTypeHandle handle = MetadataCache::GetAssemblyExportedTypeHandle(image, index);
+        Il2CppNameToTypeHandleHashTable::const_iterator iter = image->nameToClassHashTable->find(std::make_pair(namespaze, (const char*)outerName));
+        if (iter == image->nameToClassHashTable->end())
+            return NULL;
 
-            // don't add nested types
-            if (MetadataCache::TypeIsNested(handle))
-                return;
+        Il2CppMetadataTypeHandle handle = iter->second;
+        while (nestedSeparator != NULL && handle != NULL)
+        {
+            const char* nestedName = nestedSeparator + 1;
+            nestedSeparator = strchr(nestedName, '/');
+            size_t nestedNameLength = nestedSeparator != NULL ? (size_t)(nestedSeparator - nestedName) : strlen(nestedName);
 
-            AddNestedTypesToNametoClassHashTable(image, handle);
+            handle = FindNestedType(handle, nestedName, nestedNameLength);
         }
+
+        return handle;
     }
 
     Il2CppClass* Image::ClassFromName(const Il2CppImage* image, const char* namespaze, const char *name)
@@ -224,7 +208,7 @@ namespace vm
             os::FastAutoLock lock(&s_ClassFromNameMutex);
             if (!image->nameToClassHashTable)
             {
-                image->nameToClassHashTable = new Il2CppNameToTypeHandleHashTable();
+                image->nameToClassHashTable = new Il2CppNameToTypeHandleHashTable(image->typeCount + image->exportedTypeCount);
                 for (uint32_t index = 0; index < image->typeCount; index++)
                 {
                     AddTypeToNametoClassHashTable(image, MetadataCache::GetAssemblyTypeHandle(image, index));
@@ -237,6 +221,16 @@ namespace vm
             }
         }
 
+        // Nested types are named "Outer/Inner": look up the outermost type and walk down from it.
+        const char* nestedSeparator = strchr(name, '/');
+        if (nestedSeparator != NULL)
+        {
+            Il2CppMetadataTypeHandle handle = FindNestedTypeByPath(image, namespaze, name, nestedSeparator);
+            if (handle != NULL)
+                return MetadataCache::GetTypeInfoFromHandle(handle);
+        }
+
+        // Also covers top-level types whose metadata name itself contains a '/'.
         Il2CppNameToTypeHandleHashTable::const_iterator iter = image->nameToClassHashTable->find(std::make_pair(namespaze, name));
         if (iter != image->nameToClassHashTable->end())
             return MetadataCache::GetTypeInfoFromHandle(iter->second);
@@ -14,6 +14,9 @@
 #include "os/Mutex.h"
 #include "utils/CallOnce.h"
 #include "utils/Collections.h"
+#include "utils/ConcurrentAppendOnlyHashSet.h"
+#include "utils/HashUtils.h"
+#include "utils/InitOnce.h"
 #include "utils/Il2CppHashSet.h"
 #include "utils/Memory.h"
 #include "utils/PathUtils.h"
@@ -35,16 +38,34 @@
 #include "Baselib.h"
 #include "Cpp/ReentrantLock.h"
 
-typedef Il2CppReaderWriterLockedHashMap<Il2CppClass*, Il2CppClass*> PointerTypeMap;
+// Pointer classes are keyed by their element class.
+struct PointerTypeTraits
+{
+    typedef const Il2CppClass* key_type;
+    static key_type GetKey(Il2CppClass* pointerClass) { return pointerClass->element_class; }
+    static size_t Hash(key_type key) { return il2cpp::utils::HashUtils::AlignedPointerHash(key); }
+    static bool Equals(key_type left, key_type right) { return left == right; }
+};
 
-typedef Il2CppHashSet<const Il2CppGenericMethod*, il2cpp::metadata::Il2CppGenericMethodHash, il2cpp::metadata::Il2CppGenericMethodCompare> Il2CppGenericMethodSet;
-typedef Il2CppGenericMethodSet::const_iterator Il2CppGenericMethodSetIter;
+typedef il2cpp::utils::ConcurrentAppendOnlyHashSet<Il2CppClass*, PointerTypeTraits> PointerTypeSet;
+
+// The key hash only combines the method token with the (interned) inst pointers, so it is cheap
+// enough to compute on every lookup.
+struct GenericMethodTraits
+{
+    typedef const Il2CppGenericMethod* key_type;
+    static key_type GetKey(const Il2CppGenericMethod* method) { return method; }
+    static size_t Hash(key_type key) { return il2cpp::metadata::Il2CppGenericMethodHash::Hash(key); }
+    static bool Equals(key_type left, key_type right) { return il2cpp::metadata::Il2CppGenericMethodCompare::Equals(left, right); }
+};
+
+typedef il2cpp::utils::ConcurrentAppendOnlyHashSet<const Il2CppGenericMethod*, GenericMethodTraits> Il2CppGenericMethodSet;
 static Il2CppGenericMethodSet s_GenericMethodSet;
 
 struct Il2CppMetadataCache
 {
     il2cpp::os::FastReaderReaderWriterLock m_CacheLock;
-    PointerTypeMap m_PointerTypes;
+    PointerTypeSet m_PointerTypes;
 };
 
 static Il2CppMetadataCache s_MetadataCache;
@@ -54,7 +75,16 @@ static int32_t s_AssembliesCount = 0;
 static Il2CppAssembly* s_AssembliesTable = NULL;
 
 
-typedef Il2CppReaderWriterLockedHashSet<const Il2CppGenericInst*, il2cpp::metadata::Il2CppGenericInstHash, il2cpp::metadata::Il2CppGenericInstCompare> Il2CppGenericInstSet;
+struct GenericInstTraits
+{
+    typedef const Il2CppGenericInst* key_type;
+    static key_type GetKey(const Il2CppGenericInst* inst) { return inst; }
+    static size_t Hash(key_type key) { return il2cpp::metadata::Il2CppGenericInstHash::Hash(key); }
+    static bool Equals(key_type left, key_type right) { return il2cpp::metadata::Il2CppGenericInstCompare::AreEqual(left, right); }
+};
+
+// Generic instances are only ever added, so lookups of existing ones don't take g_MetadataLock.
+typedef il2cpp::utils::ConcurrentAppendOnlyHashSet<const Il2CppGenericInst*, GenericInstTraits> Il2CppGenericInstSet;
 static Il2CppGenericInstSet s_GenericInstSet;
 
 typedef il2cpp::vm::Il2CppMethodTableMap::const_iterator Il2CppMethodTableMapIter;
@@ -158,7 +188,7 @@ bool il2cpp::vm::MetadataCache::Initialize()
     il2cpp::metadata::GenericMetadata::SetMaximumRuntimeGenericDepth(s_Il2CppCodeGenOptions->maximumRuntimeGenericDepth);
     il2cpp::metadata::GenericMetadata::SetGenericVirtualIterations(s_Il2CppCodeGenOptions->recursiveGenericIterations);
 
-    s_GenericInstSet.Resize(s_MetadataCache_Il2CppMetadataRegistration->genericInstsCount);
+    s_GenericInstSet.Reserve(s_MetadataCache_Il2CppMetadataRegistration->genericInstsCount);
     for (int32_t i = 0; i < s_MetadataCache_Il2CppMetadataRegistration->genericInstsCount; i++)
     {
         bool inserted = s_GenericInstSet.Add(s_MetadataCache_Il2CppMetadataRegistration->genericInsts[i]);
@@ -212,6 +242,7 @@ bool il2cpp::vm::MetadataCache::Initialize()
     }
 
     InitializeUnresolvedSignatureTable();
+    il2cpp::vm::GlobalMetadata::InitializeAccessProfile();
 
 #if IL2CPP_ENABLE_NATIVE_STACKTRACES
     std::vector<MethodDefinitionKey> managedMethods;
@@ -323,9 +354,11 @@ void il2cpp::vm::MetadataCache::Clear()
     s_AssembliesTable = NULL;
     s_AssembliesCount = 0;
 
-    s_GenericMethodSet.clear();
+    s_GenericMethodSet.Clear();
 
     metadata::ArrayMetadata::Clear();
+    ClassInlines::ClearInterfaceVarianceCache();
+    Class::ClearMethodNameIndices();
 
     s_GenericInstSet.Clear();
 
@@ -435,7 +468,8 @@ void il2cpp::vm::MetadataCache::AddPointerTypeLocked(Il2CppClass* type, Il2CppCl
     // And WalkPointerTypes assumes this
 
     IL2CPP_ASSERT(lock.IsLock(&g_MetadataLock));
-    s_MetadataCache.m_PointerTypes.Add(type, pointerType);
+    IL2CPP_ASSERT(pointerType->element_class == type);
+    s_MetadataCache.m_PointerTypes.Add(pointerType);
 }
 
 const Il2CppGenericInst* il2cpp::vm::MetadataCache::GetGenericInst(const Il2CppType* const* types, uint32_t typeCount)
@@ -481,17 +515,23 @@ const Il2CppGenericMethod* il2cpp::vm::MetadataCache::GetGenericMethod(const Met
     method.context.class_inst = classInst;
     method.context.method_inst = methodInst;
 
+    const Il2CppGenericMethod* foundMethod;
+    if (s_GenericMethodSet.TryGet(&method, &foundMethod))
+        return foundMethod;
+
     il2cpp::os::FastAutoLock lock(&s_GenericMethodMutex);
-    Il2CppGenericMethodSet::const_iterator iter = s_GenericMethodSet.find(&method);
-    if (iter != s_GenericMethodSet.end())
-        return *iter;
+
+    // Check if the method was added while we were blocked on s_GenericMethodMutex
+    if (s_GenericMethodSet.TryGet(&method, &foundMethod))
+        return foundMethod;
 
     Il2CppGenericMethod* newMethod = MetadataAllocGenericMethod();
     newMethod->methodDefinition = methodDefinition;
     newMethod->context.class_inst = classInst;
     newMethod->context.method_inst = methodInst;
 
-    s_GenericMethodSet.insert(newMethod);
+    bool added = s_GenericMethodSet.Add(newMethod);
+    IL2CPP_ASSERT(added);
 
     return newMethod;
 }
@@ -724,27 +764,93 @@ const MethodInfo* il2cpp::vm::MetadataCache::GetMethodInfoFromVTableSlot(const I
     return il2cpp::vm::GlobalMetadata::GetMethodInfoFromVTableSlot(klass, vTableSlot);
 }
 
-static int CompareIl2CppTokenAdjustorThunkPair(const void* pkey, const void* pelem)
+// Direct-indexed views of an image's token sorted code gen tables. Each array is indexed by
+// RID - 1 and holds an index into the code gen table, or -1 if the token has no entry.
+struct Il2CppCodeGenTokenIndex
+{
+    uint32_t methodCount;
+    uint32_t typeCount;
+    int32_t* methodAdjustorThunks;
+    int32_t* methodRGCTXRanges;
+    int32_t* typeRGCTXRanges;
+};
+
+static void GetMaxTokenRowIds(uint32_t token, uint32_t* maxMethodRid, uint32_t* maxTypeRid)
 {
-    return (int)(((Il2CppTokenAdjustorThunkPair*)pkey)->token - ((Il2CppTokenAdjustorThunkPair*)pelem)->token);
+    uint32_t rid = GetTokenRowId(token);
+    if (GetTokenType(token) == IL2CPP_TOKEN_METHOD_DEF && rid > *maxMethodRid)
+        *maxMethodRid = rid;
+    else if (GetTokenType(token) == IL2CPP_TOKEN_TYPE_DEF && rid > *maxTypeRid)
+        *maxTypeRid = rid;
+}
+
+static Il2CppCodeGenTokenIndex* BuildCodeGenTokenIndex(const Il2CppCodeGenModule* codeGenModule)
+{
+    uint32_t methodCount = 0;
+    uint32_t typeCount = 0;
+    for (uint32_t i = 0; i < codeGenModule->adjustorThunkCount; i++)
+        GetMaxTokenRowIds(codeGenModule->adjustorThunks[i].token, &methodCount, &typeCount);
+    for (uint32_t i = 0; i < codeGenModule->rgctxRangesCount; i++)
+        GetMaxTokenRowIds(codeGenModule->rgctxRanges[i].token, &methodCount, &typeCount);
+
+    size_t indexCount = 2 * (size_t)methodCount + typeCount;
+    Il2CppCodeGenTokenIndex* tokenIndex = (Il2CppCodeGenTokenIndex*)il2cpp::vm::MetadataMalloc(sizeof(Il2CppCodeGenTokenIndex) + indexCount * sizeof(int32_t));
+    int32_t* indices = (int32_t*)(tokenIndex + 1);
+    memset(indices, 0xff, indexCount * sizeof(int32_t));
+
+    tokenIndex->methodCount = methodCount;
+    tokenIndex->typeCount = typeCount;
+    tokenIndex->methodAdjustorThunks = indices;
+    tokenIndex->methodRGCTXRanges = indices + methodCount;
+    tokenIndex->typeRGCTXRanges = indices + 2 * methodCount;
+
+    // Only method and type definitions carry these tables; other tokens are never indexed.
+    for (uint32_t i = 0; i < codeGenModule->adjustorThunkCount; i++)
+    {
+        uint32_t token = codeGenModule->adjustorThunks[i].token;
+        if (GetTokenType(token) == IL2CPP_TOKEN_METHOD_DEF && GetTokenRowId(token) != 0)
+            tokenIndex->methodAdjustorThunks[GetTokenRowId(token) - 1] = (int32_t)i;
+    }
+
+    for (uint32_t i = 0; i < codeGenModule->rgctxRangesCount; i++)
+    {
+        uint32_t token = codeGenModule->rgctxRanges[i].token;
+        if (GetTokenRowId(token) == 0)
+            continue;
+        if (GetTokenType(token) == IL2CPP_TOKEN_METHOD_DEF)
+            tokenIndex->methodRGCTXRanges[GetTokenRowId(token) - 1] = (int32_t)i;
+        else if (GetTokenType(token) == IL2CPP_TOKEN_TYPE_DEF)
+            tokenIndex->typeRGCTXRanges[GetTokenRowId(token) - 1] = (int32_t)i;
+    }
+
+    return tokenIndex;
 }
 
-Il2CppMethodPointer il2cpp::vm::MetadataCache::GetAdjustorThunk(const Il2CppImage* image, uint32_t token)
+static const Il2CppCodeGenTokenIndex* GetCodeGenTokenIndex(const Il2CppImage* image)
 {
-    if (image->codeGenModule->adjustorThunkCount == 0)
-        return NULL;
+    return il2cpp::utils::InitOnce(&image->codeGenTokenIndex, &il2cpp::vm::g_MetadataLock, [image](il2cpp::os::FastAutoLock& _) { return BuildCodeGenTokenIndex(image->codeGenModule); });
+}
 
-    Il2CppTokenAdjustorThunkPair key;
-    memset(&key, 0, sizeof(Il2CppTokenAdjustorThunkPair));
-    key.token = token;
+static int32_t LookupCodeGenTokenIndex(const int32_t* indices, uint32_t count, uint32_t token)
+{
+    uint32_t rid = GetTokenRowId(token);
+    if (rid == 0 || rid > count)
+        return -1;
 
-    const Il2CppTokenAdjustorThunkPair* result = (const Il2CppTokenAdjustorThunkPair*)bsearch(&key, image->codeGenModule->adjustorThunks,
-        image->codeGenModule->adjustorThunkCount, sizeof(Il2CppTokenAdjustorThunkPair), CompareIl2CppTokenAdjustorThunkPair);
+    return indices[rid - 1];
+}
 
-    if (result == NULL)
+Il2CppMethodPointer il2cpp::vm::MetadataCache::GetAdjustorThunk(const Il2CppImage* image, uint32_t token)
+{
+    if (image->codeGenModule->adjustorThunkCount == 0 || GetTokenType(token) != IL2CPP_TOKEN_METHOD_DEF)
+        return NULL;
+
+    const Il2CppCodeGenTokenIndex* tokenIndex = GetCodeGenTokenIndex(image);
+    int32_t index = LookupCodeGenTokenIndex(tokenIndex->methodAdjustorThunks, tokenIndex->methodCount, token);
+    if (index == -1)
         return NULL;
 
-    return result->adjustorThunk;
+    return image->codeGenModule->adjustorThunks[index].adjustorThunk;
 }
 
 Il2CppMethodPointer il2cpp::vm::MetadataCache::GetMethodPointer(const Il2CppImage* image, uint32_t token)
@@ -1021,26 +1127,24 @@ Il2CppInterfaceOffsetInfo il2cpp::vm::MetadataCache::GetInterfaceOffsetInfo(cons
     return il2cpp::vm::GlobalMetadata::GetInterfaceOffsetInfo(klass, index);
 }
 
-static int CompareIl2CppTokenRangePair(const void* pkey, const void* pelem)
-{
-    return (int)(((Il2CppTokenRangePair*)pkey)->token - ((Il2CppTokenRangePair*)pelem)->token);
-}
-
 il2cpp::vm::RGCTXCollection il2cpp::vm::MetadataCache::GetRGCTXs(const Il2CppImage* image, uint32_t token)
 {
     RGCTXCollection collection = { 0, NULL };
     if (image->codeGenModule->rgctxRangesCount == 0)
         return collection;
 
-    Il2CppTokenRangePair key;
-    memset(&key, 0, sizeof(Il2CppTokenRangePair));
-    key.token = token;
-
-    const Il2CppTokenRangePair* res = (const Il2CppTokenRangePair*)bsearch(&key, image->codeGenModule->rgctxRanges, image->codeGenModule->rgctxRangesCount, sizeof(Il2CppTokenRangePair), CompareIl2CppTokenRangePair);
+    const Il2CppCodeGenTokenIndex* tokenIndex = GetCodeGenTokenIndex(image);
+    int32_t index = -1;
+    if (GetTokenType(token) == IL2CPP_TOKEN_METHOD_DEF)
+        index = LookupCodeGenTokenIndex(tokenIndex->methodRGCTXRanges, tokenIndex->methodCount, token);
+    else if (GetTokenType(token) == IL2CPP_TOKEN_TYPE_DEF)
+        index = LookupCodeGenTokenIndex(tokenIndex->typeRGCTXRanges, tokenIndex->typeCount, token);
 
-    if (res == NULL)
+    if (index == -1)
         return collection;
 
+    const Il2CppTokenRangePair* res = &image->codeGenModule->rgctxRanges[index];
+
     collection.count = res->range.length;
     collection.items = image->codeGenModule->rgctxs + res->range.start;
 
@@ -1133,14 +1237,26 @@ void* il2cpp::vm::MetadataCache::InitializeRuntimeMetadata(uintptr_t* metadataPo
     return il2cpp::vm::GlobalMetadata::InitializeRuntimeMetadata(metadataPointer, true);
 }
 
+void il2cpp::vm::MetadataCache::StartAccessProfilePrewarm()
+{
+    il2cpp::vm::GlobalMetadata::StartAccessProfilePrewarm();
+}
+
+void il2cpp::vm::MetadataCache::ShutdownAccessProfile()
+{
+    il2cpp::vm::GlobalMetadata::ShutdownAccessProfile();
+}
+
+void il2cpp::vm::MetadataCache::RecordClassInitialized(const Il2CppClass* klass)
+{
+    il2cpp::vm::GlobalMetadata::RecordClassInitialized(klass);
+}
+
 void il2cpp::vm::MetadataCache::WalkPointerTypes(WalkTypesCallback callback, void* context)
 {
     os::FastAutoLock lock(&g_MetadataLock);
 
-    for (PointerTypeMap::iterator it = s_MetadataCache.m_PointerTypes.UnlockedBegin(); it != s_MetadataCache.m_PointerTypes.UnlockedEnd(); it++)
-    {
-        callback(it->second, context);
-    }
+    s_MetadataCache.m_PointerTypes.ForEach(callback, context);
 }
 
 Il2CppMetadataTypeHandle il2cpp::vm::MetadataCache::GetTypeHandleFromIndex(const Il2CppImage* image, TypeDefinitionIndex typeIndex)
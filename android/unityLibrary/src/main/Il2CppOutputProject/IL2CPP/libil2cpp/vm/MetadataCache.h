@@ -90,6 +90,9 @@ namespace vm
 
         static void InitializeAllMethodMetadata();
         static void* InitializeRuntimeMetadata(uintptr_t* metadataPointer);
+        static void StartAccessProfilePrewarm();
+        static void ShutdownAccessProfile();
+        static void RecordClassInitialized(const Il2CppClass* klass);
 
         static Il2CppMethodPointer GetAdjustorThunk(const Il2CppImage* image, uint32_t token);
         static Il2CppMethodPointer GetMethodPointer(const Il2CppImage* image, uint32_t token);
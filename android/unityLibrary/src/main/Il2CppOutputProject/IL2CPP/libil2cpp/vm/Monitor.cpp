@@ -8,6 +8,7 @@
 #include "os/Event.h"
 #include "os/Semaphore.h"
 #include "os/Thread.h"
+#include "os/ThreadLocalValue.h"
 #include "vm/Exception.h"
 #include "vm/Thread.h"
 
@@ -21,6 +22,36 @@
 
 
 // Mostly follows the algorithm outlined in "Implementing Fast Java Monitors with Relaxed-Locks".
+//
+// Uncontended locking does not use a MonitorData at all. Instead, the owning thread and the recursion
+// count are encoded directly in the object's monitor word (a "thin lock", see "Thin Locks: Featherweight
+// Synchronization for Java"). The object is only inflated to a full MonitorData once a second thread
+// needs to block on it, the recursion count overflows, or the owner calls Wait() or Pulse(). Any thread
+// may inflate a thin lock on behalf of its owner as the owner only ever modifies its thin lock through
+// compare-and-swap and will notice the inflation.
+//
+// Monitor word layout:
+//  - NULL: unlocked.
+//  - Bits 0-1 == 01: thin lock. Bits 2-9 hold the recursion count, the remaining bits the owner ID.
+//  - Otherwise: pointer to the MonitorData the object is inflated to.
+
+/// Small, never reused per-thread ID identifying the owner of a lock. Thin locks need the owner ID
+/// to fit into a pointer-sized word next to the recursion count, which OS thread IDs do not.
+static il2cpp::os::ThreadLocalValue s_LockOwnerId;
+static baselib::atomic<size_t> s_LastLockOwnerId(0);
+
+static size_t GetCurrentLockOwnerId()
+{
+    void* value;
+    s_LockOwnerId.GetValue(&value);
+    if (value == NULL)
+    {
+        value = reinterpret_cast<void*>(static_cast<uintptr_t>(++s_LastLockOwnerId));
+        s_LockOwnerId.SetValue(value);
+    }
+
+    return static_cast<size_t>(reinterpret_cast<uintptr_t>(value));
+}
 
 /// State of a lock associated with an object.
 ///
@@ -33,14 +64,15 @@
 //  are already back on the free list (and maybe even in use somewhere else already).
 struct MonitorData : public il2cpp::utils::ThreadSafeFreeListNode
 {
-    static const il2cpp::os::Thread::ThreadId kCanBeAcquiredByOtherThread = il2cpp::os::Thread::kInvalidThreadId;
+    static const il2cpp::os::Thread::ThreadId kCanBeAcquiredByOtherThread = 0;
     static const il2cpp::os::Thread::ThreadId kHasBeenReturnedToFreeList = (il2cpp::os::Thread::ThreadId)-1;
 
-    /// ID of thread that currently has the object locked or one of the two values above.
+    /// Lock owner ID (see GetCurrentLockOwnerId()) of thread that currently has the object locked or
+    /// one of the two values above.
     ///
     /// This signals three possible states:
     ///
-    /// 1) Contains a valid thread ID. Means the monitor is owned by that thread and only that thread can
+    /// 1) Contains a valid lock owner ID. Means the monitor is owned by that thread and only that thread can
     ///    change the value of this field.
     /// 2) Contains kCanBeAcquiredByOtherThread. Means monitor is still live and attached to an object
     ///    but is up for grabs by whichever thread manages to swap the value of this field for its own
@@ -155,7 +187,7 @@ struct MonitorData : public il2cpp::utils::ThreadSafeFreeListNode
 
     void Unacquire()
     {
-        IL2CPP_ASSERT(owningThreadId == il2cpp::os::Thread::CurrentThreadId());
+        IL2CPP_ASSERT(owningThreadId == GetCurrentLockOwnerId());
         // Use `exchange` rather than `store` to ensure this is a read-modify-write
         // operation and all threads observe modifications in the same order,
         // i.e. changes within the `lock` block occur before the acquisition
@@ -209,7 +241,7 @@ struct MonitorData : public il2cpp::utils::ThreadSafeFreeListNode
     /// NOTE: Calling thread *must* have the monitor locked.
     PulseWaitingListNode* PopNextFromPulseWaitingList()
     {
-        IL2CPP_ASSERT(owningThreadId == il2cpp::os::Thread::CurrentThreadId());
+        IL2CPP_ASSERT(owningThreadId == GetCurrentLockOwnerId());
 
         PulseWaitingListNode* head = threadsWaitingForPulse;
         if (!head)
@@ -230,7 +262,7 @@ struct MonitorData : public il2cpp::utils::ThreadSafeFreeListNode
     /// NOTE: Calling thread *must* have the monitor locked.
     bool RemoveFromPulseWaitingList(PulseWaitingListNode* node)
     {
-        IL2CPP_ASSERT(owningThreadId == il2cpp::os::Thread::CurrentThreadId());
+        IL2CPP_ASSERT(owningThreadId == GetCurrentLockOwnerId());
 
         // This function works only because threads calling Wait() on the monitor will only
         // ever *prepend* nodes to the list. This means that only the "threadsWaitingForPulse"
@@ -275,10 +307,73 @@ struct MonitorData : public il2cpp::utils::ThreadSafeFreeListNode
 il2cpp::utils::ThreadSafeFreeList<MonitorData> MonitorData::s_FreeList;
 il2cpp::utils::ThreadSafeFreeList<MonitorData::PulseWaitingListNode> MonitorData::PulseWaitingListNode::s_FreeList;
 
+static const uintptr_t kThinLockTag = 1;
+static const uintptr_t kThinLockTagMask = 3;
+static const int kThinLockRecursionCountShift = 2;
+static const uint32_t kThinLockMaxRecursionCount = 0xFF;
+static const int kThinLockOwnerIdShift = 10;
+static const size_t kThinLockMaxOwnerId = (size_t)(UINTPTR_MAX >> kThinLockOwnerIdShift);
+
+static inline bool IsThinLock(MonitorData* monitor)
+{
+    return (reinterpret_cast<uintptr_t>(monitor) & kThinLockTagMask) == kThinLockTag;
+}
+
+static inline MonitorData* MakeThinLock(size_t ownerId, uint32_t recursionCount)
+{
+    IL2CPP_ASSERT(ownerId <= kThinLockMaxOwnerId);
+    IL2CPP_ASSERT(recursionCount > 0 && recursionCount <= kThinLockMaxRecursionCount);
+    uintptr_t value = (static_cast<uintptr_t>(ownerId) << kThinLockOwnerIdShift) | (static_cast<uintptr_t>(recursionCount) << kThinLockRecursionCountShift) | kThinLockTag;
+    return reinterpret_cast<MonitorData*>(value);
+}
+
+static inline size_t GetThinLockOwnerId(MonitorData* thinLock)
+{
+    return static_cast<size_t>(reinterpret_cast<uintptr_t>(thinLock) >> kThinLockOwnerIdShift);
+}
+
+static inline uint32_t GetThinLockRecursionCount(MonitorData* thinLock)
+{
+    return static_cast<uint32_t>((reinterpret_cast<uintptr_t>(thinLock) >> kThinLockRecursionCountShift) & kThinLockMaxRecursionCount);
+}
+
+/// Replace the given thin lock on the object with a MonitorData that is owned by the same thread with
+/// the same recursion count. Does nothing if the monitor word no longer holds the given thin lock (the
+/// owner released or changed it, or another thread inflated it first); callers re-read the word and retry.
+static void InflateThinLock(Il2CppObject* obj, MonitorData* thinLock)
+{
+    MonitorData* monitor = MonitorData::s_FreeList.Allocate();
+    il2cpp::os::Thread::ThreadId previousOwnerThreadId = monitor->owningThreadId.exchange(GetThinLockOwnerId(thinLock));
+    IL2CPP_ASSERT(previousOwnerThreadId == MonitorData::kHasBeenReturnedToFreeList && "Monitor on freelist cannot be owned by thread!");
+    NO_UNUSED_WARNING(previousOwnerThreadId);
+    monitor->recursiveLockingCount = GetThinLockRecursionCount(thinLock);
+
+    if (il2cpp::os::Atomic::CompareExchangePointer(&obj->monitor, monitor, thinLock) != thinLock)
+    {
+        monitor->recursiveLockingCount = 1;
+        monitor->owningThreadId = MonitorData::kHasBeenReturnedToFreeList;
+        MonitorData::s_FreeList.Release(monitor);
+    }
+}
+
 static MonitorData* GetMonitorAndThrowIfNotLockedByCurrentThread(Il2CppObject* obj)
 {
     // Fetch monitor data.
     MonitorData* monitor = il2cpp::os::Atomic::ReadPointer(&obj->monitor);
+
+    // Wait() and Pulse() need the wait lists of a full monitor so inflate thin locks we own.
+    while (IsThinLock(monitor))
+    {
+        if (GetThinLockOwnerId(monitor) != GetCurrentLockOwnerId())
+        {
+            il2cpp::vm::Exception::Raise(il2cpp::vm::Exception::GetSynchronizationLockException
+                    ("Object has not been locked by this thread."));
+        }
+
+        InflateThinLock(obj, monitor);
+        monitor = il2cpp::os::Atomic::ReadPointer(&obj->monitor);
+    }
+
     if (!monitor)
     {
         // No one locked this object.
@@ -287,7 +382,7 @@ static MonitorData* GetMonitorAndThrowIfNotLockedByCurrentThread(Il2CppObject* o
 
     // Throw SynchronizationLockException if we're not holding a lock.
     // NOTE: Unlike .NET, Mono simply ignores this and does not throw.
-    uint64_t currentThreadId = il2cpp::os::Thread::CurrentThreadId();
+    uint64_t currentThreadId = GetCurrentLockOwnerId();
     if (monitor->owningThreadId != currentThreadId && !monitor->threadAborted)
     {
         il2cpp::vm::Exception::Raise(il2cpp::vm::Exception::GetSynchronizationLockException
@@ -308,17 +403,57 @@ namespace vm
 
     bool Monitor::TryEnter(Il2CppObject* obj, uint32_t timeOutMilliseconds)
     {
-        size_t currentThreadId = il2cpp::os::Thread::CurrentThreadId();
+        size_t currentThreadId = GetCurrentLockOwnerId();
+        const bool canUseThinLock = currentThreadId <= kThinLockMaxOwnerId;
 
         while (true)
         {
             MonitorData* installedMonitor = il2cpp::os::Atomic::ReadPointer(&obj->monitor);
+            if (!installedMonitor && canUseThinLock)
+            {
+                // No one has the object locked. Claim it with a thin lock. This is the fast path.
+                if (il2cpp::os::Atomic::CompareExchangePointer(&obj->monitor, MakeThinLock(currentThreadId, 1), (MonitorData*)NULL) == NULL)
+                    return true;
+
+                // Some other thread raced us and won. Retry.
+                continue;
+            }
+
+            if (IsThinLock(installedMonitor))
+            {
+                bool isOwnedByCurrentThread = GetThinLockOwnerId(installedMonitor) == currentThreadId;
+                if (isOwnedByCurrentThread)
+                {
+                    uint32_t recursionCount = GetThinLockRecursionCount(installedMonitor);
+                    if (recursionCount < kThinLockMaxRecursionCount)
+                    {
+                        // Recursive lock. If the CAS fails, some other thread has inflated
+                        // our lock and we take the recursive path on the MonitorData.
+                        MonitorData* newThinLock = MakeThinLock(currentThreadId, recursionCount + 1);
+                        if (il2cpp::os::Atomic::CompareExchangePointer(&obj->monitor, newThinLock, installedMonitor) == installedMonitor)
+                            return true;
+                        continue;
+                    }
+                }
+                else if (timeOutMilliseconds == 0)
+                {
+                    // Locked by another thread and we are not supposed to wait.
+                    return false;
+                }
+
+                // Either locked by another thread, in which case we need a full monitor to block on,
+                // or our recursion count does not fit in the thin lock anymore. Inflate and retry.
+                InflateThinLock(obj, installedMonitor);
+                continue;
+            }
+
             if (!installedMonitor)
             {
                 // Set up a new monitor.
                 MonitorData* newlyAllocatedMonitorForThisThread = MonitorData::s_FreeList.Allocate();
                 il2cpp::os::Thread::ThreadId previousOwnerThreadId = newlyAllocatedMonitorForThisThread->owningThreadId.exchange(currentThreadId);
                 IL2CPP_ASSERT(previousOwnerThreadId == MonitorData::kHasBeenReturnedToFreeList && "Monitor on freelist cannot be owned by thread!");
+                NO_UNUSED_WARNING(previousOwnerThreadId);
 
                 // Try to install the monitor on the object (aka "inflate" the object).
                 if (il2cpp::os::Atomic::CompareExchangePointer(&obj->monitor, newlyAllocatedMonitorForThisThread, (MonitorData*)NULL) == NULL)
@@ -491,6 +626,28 @@ namespace vm
 
     void Monitor::Exit(Il2CppObject* obj)
     {
+        MonitorData* installedMonitor = il2cpp::os::Atomic::ReadPointer(&obj->monitor);
+        while (IsThinLock(installedMonitor))
+        {
+            size_t currentThreadId = GetCurrentLockOwnerId();
+            if (GetThinLockOwnerId(installedMonitor) != currentThreadId)
+            {
+                il2cpp::vm::Exception::Raise(il2cpp::vm::Exception::GetSynchronizationLockException
+                        ("Object has not been locked by this thread."));
+            }
+
+            // Undo one single invocation of Enter(). Nothing to wake up as no one can be blocked
+            // on a thin lock.
+            uint32_t recursionCount = GetThinLockRecursionCount(installedMonitor);
+            MonitorData* newValue = recursionCount > 1 ? MakeThinLock(currentThreadId, recursionCount - 1) : NULL;
+            MonitorData* previousValue = il2cpp::os::Atomic::CompareExchangePointer(&obj->monitor, newValue, installedMonitor);
+            if (previousValue == installedMonitor)
+                return;
+
+            // Another thread inflated our lock. Exit through the MonitorData.
+            installedMonitor = previousValue;
+        }
+
         // Fetch monitor data.
         MonitorData* monitor = GetMonitorAndThrowIfNotLockedByCurrentThread(obj);
 
@@ -565,7 +722,7 @@ namespace vm
             //   realizing the mistake.
 
             // Release monitor back to free list.
-            IL2CPP_ASSERT(monitor->owningThreadId == il2cpp::os::Thread::CurrentThreadId());
+            IL2CPP_ASSERT(monitor->owningThreadId == GetCurrentLockOwnerId());
             monitor->owningThreadId = MonitorData::kHasBeenReturnedToFreeList;
             MonitorData::s_FreeList.Release(monitor);
         }
@@ -656,8 +813,8 @@ namespace vm
         // Reacquire the monitor.
         Enter(object);
 
-        // Monitor *may* have changed.
-        monitor = object->monitor;
+        // Monitor *may* have changed. We may even have reacquired the object with a thin lock.
+        monitor = GetMonitorAndThrowIfNotLockedByCurrentThread(object);
 
         // Restore recursion count.
         monitor->recursiveLockingCount = oldLockingCount;
@@ -691,20 +848,26 @@ namespace vm
 
     bool Monitor::IsAcquired(Il2CppObject* object)
     {
-        MonitorData* monitor = object->monitor;
+        MonitorData* monitor = il2cpp::os::Atomic::ReadPointer(&object->monitor);
         if (!monitor)
             return false;
 
+        if (IsThinLock(monitor))
+            return true;
+
         return monitor->IsAcquired();
     }
 
     bool Monitor::IsOwnedByCurrentThread(Il2CppObject* object)
     {
-        MonitorData* monitor = object->monitor;
+        MonitorData* monitor = il2cpp::os::Atomic::ReadPointer(&object->monitor);
         if (!monitor)
             return false;
 
-        return monitor->IsOwnedByThread(il2cpp::os::Thread::CurrentThreadId());
+        if (IsThinLock(monitor))
+            return GetThinLockOwnerId(monitor) == GetCurrentLockOwnerId();
+
+        return monitor->IsOwnedByThread(GetCurrentLockOwnerId());
     }
 } /* namespace vm */
 } /* namespace il2cpp */
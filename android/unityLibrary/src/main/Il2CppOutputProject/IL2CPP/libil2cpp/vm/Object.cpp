@@ -29,6 +29,11 @@
 #if IL2CPP_GC_BOEHM
 #define ALLOC_PTRFREE(obj, vt, size) do { (obj) = (Il2CppObject*)GC_MALLOC_ATOMIC ((size)); (obj)->klass = (vt); (obj)->monitor = NULL;} while (0)
 #define ALLOC_OBJECT(obj, vt, size) do { (obj) = (Il2CppObject*)GC_MALLOC ((size)); (obj)->klass = (vt);} while (0)
+#if IL2CPP_ENABLE_WRITE_BARRIER_VALIDATION
+#define ALLOC_PTRFREE_ZEROED(obj, vt, size) do { (obj) = (Il2CppObject*)GC_MALLOC_ATOMIC ((size)); memset((obj), 0, (size)); (obj)->klass = (vt);} while (0)
+#else
+#define ALLOC_PTRFREE_ZEROED(obj, vt, size) do { (obj) = (Il2CppObject*)GC_malloc_atomic_zeroed ((size)); (obj)->klass = (vt);} while (0)
+#endif
 #ifdef GC_GCJ_SUPPORT
 #define ALLOC_TYPED(dest, size, type) do { (dest) = (Il2CppObject*)GC_gcj_malloc ((size),(type)); } while (0)
 #else
@@ -39,10 +44,12 @@
 #ifdef HAVE_SGEN_GC
 #define GC_NO_DESCRIPTOR (NULL)
 #define ALLOC_PTRFREE(obj, vt, size) do { (obj) = mono_gc_alloc_obj (vt, size);} while (0)
+#define ALLOC_PTRFREE_ZEROED(obj, vt, size) do { (obj) = mono_gc_alloc_obj (vt, size);} while (0)
 #define ALLOC_OBJECT(obj, vt, size) do { (obj) = mono_gc_alloc_obj (vt, size);} while (0)
 #define ALLOC_TYPED(dest, size, type) do { (dest) = mono_gc_alloc_obj (type, size);} while (0)
 #else
 #define ALLOC_PTRFREE(obj, vt, size) do { (obj) = (Il2CppObject*)malloc ((size)); (obj)->klass = (vt); (obj)->monitor = NULL;} while (0)
+#define ALLOC_PTRFREE_ZEROED(obj, vt, size) do { (obj) = (Il2CppObject*)calloc (1, (size)); (obj)->klass = (vt);} while (0)
 #define ALLOC_OBJECT(obj, vt, size) do { (obj) = (Il2CppObject*)calloc (1, (size)); (obj)->klass = (vt);} while (0)
 #define ALLOC_TYPED(dest, size, type) do { (dest) = (Il2CppObject*)(calloc (1, (size))); *(void**)dest = (type);} while (0)
 #endif
@@ -74,6 +81,17 @@ namespace vm
         return o;
     }
 
+    Il2CppObject * Object::AllocatePtrFreeZeroed(size_t size, Il2CppClass *typeInfo)
+    {
+        IL2CPP_ASSERT(typeInfo->initialized);
+        Il2CppObject *o;
+        ALLOC_PTRFREE_ZEROED(o, typeInfo, size);
+
+        ++il2cpp_runtime_stats.new_object_count;
+
+        return o;
+    }
+
     Il2CppObject * Object::AllocateSpec(size_t size, Il2CppClass *typeInfo)
     {
         IL2CPP_ASSERT(typeInfo->initialized);
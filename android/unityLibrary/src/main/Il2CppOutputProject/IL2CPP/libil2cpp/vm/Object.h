@@ -35,6 +35,7 @@ namespace vm
         static Il2CppObject* NewPtrFree(Il2CppClass *klass);
         static Il2CppObject* Allocate(size_t size, Il2CppClass *typeInfo);
         static Il2CppObject* AllocatePtrFree(size_t size, Il2CppClass *typeInfo);
+        static Il2CppObject* AllocatePtrFreeZeroed(size_t size, Il2CppClass *typeInfo);
         static Il2CppObject* AllocateSpec(size_t size, Il2CppClass *typeInfo);
 
         // Yo! Don't call this function! See the comments in the implementation if you do.
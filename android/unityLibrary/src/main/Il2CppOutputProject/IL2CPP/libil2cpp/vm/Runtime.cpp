@@ -316,8 +316,6 @@ namespace vm
         // Reflection needs GC initialized
         Reflection::Initialize();
 
-        Image::InitNestedTypes(il2cpp_defaults.corlib);
-
         const Il2CppAssembly* systemDll = Assembly::Load("System");
         if (systemDll != NULL)
             il2cpp_defaults.system_uri_class = Class::FromName(Assembly::GetImage(systemDll), "System", "Uri");
@@ -398,6 +396,8 @@ namespace vm
             utils::Environment::SetMainArgs(mainArgs, 1);
         }
 
+        vm::MetadataCache::StartAccessProfilePrewarm();
+
         vm::MetadataCache::ExecuteEagerStaticClassConstructors();
         vm::MetadataCache::ExecuteModuleInitializers();
 
@@ -422,6 +422,10 @@ namespace vm
         MONO_PROFILER_RAISE(runtime_shutdown_end, ());
 #endif
 
+        // Stop any metadata prewarm before threads are aborted, and write the recorded profile while
+        // the metadata it describes is still loaded
+        MetadataCache::ShutdownAccessProfile();
+
 #if IL2CPP_SUPPORT_THREADS
         threadpool_ms_cleanup();
 #endif